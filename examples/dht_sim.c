@@ -0,0 +1,206 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* DHT22 sensor simulation.
+
+   Probes simulated DHT22 sensor via GPIO/clock SIM drivers, therefore the
+   example may be run off-target (no BCM platform required). The sensor
+   response is produced by the simulator's waveform callback timed from the
+   simulated STC. The example reports decoded readings, failures and the probe
+   time statistics. Note the simulated STC runs in real time, therefore
+   scheduling gaps (e.g. on virtualized hosts) corrupt the readings as on the
+   real hardware. Usage:
+
+     dht_sim [n-probes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "librasp/sim.h"
+#include "librasp/devices/dht.h"
+
+#define DHT_GPIO    4
+
+/* simulated readings: 65.8%RH, 26.9C */
+#define SIM_RH      658
+#define SIM_TEMP    269
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+/* DHT22 response signal segment */
+typedef struct _dht_seg_t
+{
+    uint32_t end;       /* segment end since the host's start signal end [us] */
+    bool_t low;         /* the sensor pulls the wire low */
+} dht_seg_t;
+
+/* simulated sensor */
+typedef struct _dht_sim_t
+{
+    unsigned int gpio;
+    enum { sens_idle=0, sens_start, sens_resp } state;
+    uint64_t t_start;   /* start signal/response start tick */
+
+    size_t n_segs;
+    dht_seg_t segs[2+2+2*40+1];
+} dht_sim_t;
+
+static void add_seg(dht_sim_t *p_sens, uint32_t len, bool_t low)
+{
+    uint32_t end = (p_sens->n_segs ? p_sens->segs[p_sens->n_segs-1].end : 0);
+
+    p_sens->segs[p_sens->n_segs].end = end+len;
+    p_sens->segs[p_sens->n_segs++].low = low;
+}
+
+/* prepare the sensor response for 'rh', 'temp' readings */
+static void dht_sim_init(dht_sim_t *p_sens, unsigned int gpio, int rh, int temp)
+{
+    unsigned int i;
+    uint8_t data[5];
+
+    memset(p_sens, 0, sizeof(*p_sens));
+    p_sens->gpio = gpio;
+
+    data[0] = (uint8_t)(rh>>8);
+    data[1] = (uint8_t)rh;
+    data[2] = (uint8_t)((temp<0 ? -temp : temp)>>8) | (temp<0 ? 0x80 : 0);
+    data[3] = (uint8_t)(temp<0 ? -temp : temp);
+    data[4] = (uint8_t)(data[0]+data[1]+data[2]+data[3]);
+
+    /* response delay, then 80us low, 80us high */
+    add_seg(p_sens, 30, FALSE);
+    add_seg(p_sens, 80, TRUE);
+    add_seg(p_sens, 80, FALSE);
+
+    /* data bits: 50us low followed by 26us (0) or 70us (1) high */
+    for (i=0; i<8*sizeof(data); i++) {
+        add_seg(p_sens, 50, TRUE);
+        add_seg(p_sens, ((data[i>>3]>>(7-(i&7)))&1 ? 70 : 26), FALSE);
+    }
+
+    /* end of transmission */
+    add_seg(p_sens, 50, TRUE);
+}
+
+/* simulator waveform callback */
+static uint64_t dht_sim_wave(void *arg,
+    uint64_t tick, uint64_t outs, uint64_t out_levs, uint64_t *p_drv)
+{
+    dht_sim_t *p_sens = (dht_sim_t*)arg;
+    uint64_t pin = GPIO_MASK(p_sens->gpio);
+    bool_t host_low = ((outs & pin) && !(out_levs & pin));
+    size_t i;
+
+    *p_drv = 0;
+
+    switch (p_sens->state)
+    {
+    case sens_idle:
+        if (host_low) {
+            p_sens->state = sens_start;
+            p_sens->t_start = tick;
+        }
+        break;
+
+    case sens_start:
+        if (!host_low) {
+            /* start signal must last at least 1ms */
+            if (tick-p_sens->t_start >= 1000) {
+                p_sens->state = sens_resp;
+                p_sens->t_start = tick;
+            } else
+                p_sens->state = sens_idle;
+        }
+        break;
+
+    case sens_resp:
+        for (i=0; i<p_sens->n_segs; i++) {
+            if (tick-p_sens->t_start < p_sens->segs[i].end) {
+                /* the wire is pulled up while released */
+                if (p_sens->segs[i].low) *p_drv = pin;
+                break;
+            }
+        }
+        if (i>=p_sens->n_segs) p_sens->state = sens_idle;
+        break;
+    }
+    /* the sensor drives the wire low only */
+    return 0;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    bool_t gh_init=FALSE, ch_init=FALSE;
+    gpio_hndl_t gpio_h;
+    clock_hndl_t clk_h;
+    dht_sim_t sens;
+    unsigned int i, n_ok=0, n_probes = (argc>1 ? (unsigned int)atoi(argv[1]) : 10);
+    uint64_t start, t, t_min=(uint64_t)-1, t_max=0, t_sum=0;
+
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_sim));
+    gh_init = TRUE;
+    EXEC_G(clock_init(&clk_h, clock_drv_sim));
+    ch_init = TRUE;
+
+    dht_sim_init(&sens, DHT_GPIO, SIM_RH, SIM_TEMP);
+    EXEC_G(sim_set_wave(dht_sim_wave, &sens));
+
+    EXEC_G(gpio_direction_input(&gpio_h, DHT_GPIO));
+    EXEC_G(gpio_bcm_set_pull_config(&gpio_h, DHT_GPIO, gpio_bcm_pull_up));
+
+    for (i=0; i<n_probes; i++)
+    {
+        unsigned int rh;
+        int temp;
+        lr_errc_t ret;
+
+        sens.state = sens_idle;
+
+        start = time_ns();
+        ret = dht_probe(&gpio_h, &clk_h, DHT_GPIO, dht22, &rh, &temp);
+        t = time_ns()-start;
+
+        t_sum += t;
+        t_min = MIN(t_min, t);
+        t_max = MAX(t_max, t);
+
+        if (ret==LREC_SUCCESS) {
+            if (rh==SIM_RH && temp==SIM_TEMP) n_ok++;
+            printf("Probe %u: RH: %d.%d%%, temp: %d.%dC\n",
+                i, rh/10, rh%10, temp/10, abs(temp%10));
+        } else {
+            printf("Probe %u: error %d\n", i, ret);
+        }
+    }
+
+    if (n_probes) {
+        printf("Correct readings: %u/%u; probe time [ms] min: %.3f, "
+            "avg: %.3f, max: %.3f\n", n_ok, n_probes, t_min/1e6,
+            t_sum/1e6/n_probes, t_max/1e6);
+    }
+
+finish:
+    sim_set_wave(NULL, NULL);
+    if (ch_init) clock_free(&clk_h);
+    if (gh_init) gpio_free(&gpio_h);
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO and clock drivers automatic selection.
+
+   Initializes GPIO and clock handles with the AUTO drivers and prints the
+   drivers probing results: per-operation costs of the available built-in
+   drivers and the selected ones. No GPIO configuration is changed.
+ */
+
+#include <stdio.h>
+#include "librasp/clock.h"
+#include "librasp/gpio.h"
+
+static const char *gpio_drv_names[] = {
+    [gpio_drv_io] = "io (/dev/mem)",
+    [gpio_drv_gpio] = "gpio (/dev/gpiomem)",
+    [gpio_drv_sysfs] = "sysfs",
+    [gpio_drv_cdev] = "cdev (" DEV_GPIOCHIP ")",
+    [gpio_drv_sim] = "sim"
+};
+
+static const char *clock_drv_names[] = {
+    [clock_drv_io] = "io (STC)",
+    [clock_drv_sys] = "sys",
+    [clock_drv_sim] = "sim"
+};
+
+static void print_cost(const char *name, uint32_t cost, bool_t sel)
+{
+    if (cost) printf("  %-24s %6u ns/op%s\n", name, cost, (sel ? " *" : ""));
+    else printf("  %-24s    n/a%s\n", name, (sel ? " *" : ""));
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int i;
+    gpio_hndl_t gpio_h;
+    clock_hndl_t clk_h;
+    gpio_drv_probe_t gpio_probe;
+    clock_drv_probe_t clk_probe;
+
+    if (gpio_init(&gpio_h, gpio_drv_auto)==LREC_SUCCESS) {
+        printf("GPIO driver: %s\n", gpio_drv_names[gpio_h.drv]);
+        gpio_free(&gpio_h);
+    }
+
+    gpio_get_drv_probe(&gpio_probe);
+    printf("GPIO drivers probing (read GPIO levels or driver's equivalent; "
+        "sysfs is a fallback, not probed):\n");
+    for (i=0; i<ARRAY_SZ(gpio_probe.costs); i++) {
+        if (i!=gpio_drv_sim) {
+            print_cost(gpio_drv_names[i],
+                gpio_probe.costs[i], (i==gpio_probe.drv));
+        }
+    }
+
+    if (clock_init(&clk_h, clock_drv_auto)==LREC_SUCCESS) {
+        printf("Clock driver: %s\n", clock_drv_names[clk_h.drv]);
+        clock_free(&clk_h);
+    }
+
+    clock_get_drv_probe(&clk_probe);
+    printf("Clock drivers probing (read 32-bit ticks):\n");
+    for (i=0; i<ARRAY_SZ(clk_probe.costs); i++) {
+        if (i!=clock_drv_sim) {
+            print_cost(clock_drv_names[i],
+                clk_probe.costs[i], (i==clk_probe.drv));
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO output throughput benchmark.
+
+   Drives an 8-bit parallel bus connected to GPIO_BUS_FIRST..GPIO_BUS_FIRST+7
+   pins with a sequence of words and compares per-pin gpio_set_value() writes
+   with bank-wide gpio_write_bank() ones. For I/O drivers the GPIO_BUS_FIRST
+   pin toggle rate via gpio_set_value() and the inline gpio_io_set_fast() is
+   measured in addition. Usage:
+
+     gpio_bench [io|gpio|sysfs]
+
+   NOTE: The bus pins are configured as outputs for the time of the benchmark.
+   Make sure nothing is connected to them which may be harmed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "librasp/gpio.h"
+
+#define GPIO_BUS_FIRST  16
+#define GPIO_BUS_WIDTH  8
+
+#define GPIO_BUS_MASK \
+    ((GPIO_MASK(GPIO_BUS_WIDTH)-1)<<GPIO_BUS_FIRST)
+
+#define WORDS_IO        1000000U
+#define WORDS_SYSFS     10000U
+#define TOGGLES         10000000U
+
+/* sysfs export access rights wait timeout [ms] */
+#define EXPORT_TIMEOUT  1000
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+static double time_sec(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (double)tp.tv_sec + (double)tp.tv_nsec/1e9;
+}
+
+static void print_res(const char *name,
+    const char *unit, unsigned int n, double time)
+{
+    printf("  %-20s %u %ss in %.3f sec; %.0f %ss/sec, %.1f ns/%s\n",
+        name, n, unit, time, n/time, unit, 1e9*time/n, unit);
+}
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE, exprt=FALSE;
+    gpio_hndl_t gpio_h;
+    gpio_driver_t drv=gpio_drv_gpio;
+    unsigned int i, b, words;
+    double start;
+
+    if (argc>1) {
+        if (!strcmp(argv[1], "io")) drv=gpio_drv_io;
+        else
+        if (!strcmp(argv[1], "gpio")) drv=gpio_drv_gpio;
+        else
+        if (!strcmp(argv[1], "sysfs")) drv=gpio_drv_sysfs;
+        else {
+            printf("Usage: %s [io|gpio|sysfs]\n", argv[0]);
+            goto finish;
+        }
+    }
+    words = (drv==gpio_drv_sysfs ? WORDS_SYSFS : WORDS_IO);
+
+    EXEC_G(gpio_init(&gpio_h, drv));
+    h_init = TRUE;
+
+    if (drv==gpio_drv_sysfs) {
+        exprt = TRUE;
+        EXEC_G(gpio_sysfs_export_many(&gpio_h, GPIO_BUS_MASK, EXPORT_TIMEOUT));
+    }
+    for (b=0; b<GPIO_BUS_WIDTH; b++)
+        EXEC_G(gpio_direction_output(&gpio_h, GPIO_BUS_FIRST+b, 0));
+
+    printf("Writing %d-bit bus on GPIO%d-%d\n", GPIO_BUS_WIDTH,
+        GPIO_BUS_FIRST, GPIO_BUS_FIRST+GPIO_BUS_WIDTH-1);
+
+    start = time_sec();
+    for (i=0; i<words; i++) {
+        for (b=0; b<GPIO_BUS_WIDTH; b++)
+            gpio_set_value(&gpio_h, GPIO_BUS_FIRST+b, (i>>b)&1);
+    }
+    print_res("gpio_set_value()", "word", words, time_sec()-start);
+
+    start = time_sec();
+    for (i=0; i<words; i++) {
+        gpio_write_bank(&gpio_h, GPIO_BUS_MASK, (uint64_t)i<<GPIO_BUS_FIRST);
+    }
+    print_res("gpio_write_bank()", "word", words, time_sec()-start);
+
+    if (drv!=gpio_drv_sysfs)
+    {
+        printf("Toggling GPIO%d\n", GPIO_BUS_FIRST);
+
+        start = time_sec();
+        for (i=0; i<TOGGLES; i++)
+            gpio_set_value(&gpio_h, GPIO_BUS_FIRST, i&1);
+        print_res("gpio_set_value()", "toggle", TOGGLES, time_sec()-start);
+
+        start = time_sec();
+        for (i=0; i<TOGGLES; i++)
+            gpio_io_set_fast(&gpio_h, GPIO_BUS_FIRST, i&1);
+        print_res("gpio_io_set_fast()", "toggle", TOGGLES, time_sec()-start);
+    }
+
+finish:
+    if (h_init) {
+        /* protect the out pins */
+        for (b=0; b<GPIO_BUS_WIDTH; b++) {
+            gpio_direction_input(&gpio_h, GPIO_BUS_FIRST+b);
+            if (exprt) gpio_sysfs_unexport(&gpio_h, GPIO_BUS_FIRST+b);
+        }
+        gpio_free(&gpio_h);
+    }
+    return 0;
+}
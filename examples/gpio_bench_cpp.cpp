@@ -0,0 +1,140 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* C++ compile-time GPIO pins/ports benchmark.
+
+   Drives an 8-bit parallel bus connected to GPIO_BUS_FIRST..GPIO_BUS_FIRST+7
+   pins with a sequence of words and compares the C API calls (per-pin
+   gpio_set_value(), bank-wide gpio_write_bank(), inline fast path
+   gpio_io_write_bank_fast()) with librasp::Port<>::write() of librasp/gpio.hpp.
+   GPIO_BUS_FIRST pin toggle rate is compared in the same way. The "sim" mode
+   runs the benchmark off-target on the BCM simulator (the fast path writes
+   are not synchronized with the simulator then, so only the calls costs are
+   compared). Usage:
+
+     gpio_bench_cpp [io|gpio|sim]
+
+   NOTE: The bus pins are configured as outputs for the time of the benchmark.
+   Make sure nothing is connected to them which may be harmed.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include "librasp/gpio.hpp"
+
+#define GPIO_BUS_FIRST  16
+#define GPIO_BUS_WIDTH  8
+
+#define GPIO_BUS_MASK \
+    ((GPIO_MASK(GPIO_BUS_WIDTH)-1)<<GPIO_BUS_FIRST)
+
+#define WORDS           1000000U
+#define TOGGLES         10000000U
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+using Bus = librasp::Port<16, 17, 18, 19, 20, 21, 22, 23>;
+using Tgl = librasp::Pin<GPIO_BUS_FIRST>;
+
+static_assert(Bus::mask==GPIO_BUS_MASK, "Bus pins mismatch");
+
+static double time_sec(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (double)tp.tv_sec + (double)tp.tv_nsec/1e9;
+}
+
+static void print_res(const char *name,
+    const char *unit, unsigned int n, double time)
+{
+    printf("  %-28s %u %ss in %.3f sec; %.0f %ss/sec, %.1f ns/%s\n",
+        name, n, unit, time, n/time, unit, 1e9*time/n, unit);
+}
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE;
+    gpio_hndl_t gpio_h;
+    gpio_driver_t drv=gpio_drv_gpio;
+    unsigned int i, b;
+    double start;
+
+    if (argc>1) {
+        if (!strcmp(argv[1], "io")) drv=gpio_drv_io;
+        else
+        if (!strcmp(argv[1], "gpio")) drv=gpio_drv_gpio;
+        else
+        if (!strcmp(argv[1], "sim")) drv=gpio_drv_sim;
+        else {
+            printf("Usage: %s [io|gpio|sim]\n", argv[0]);
+            goto finish;
+        }
+    }
+
+    EXEC_G(gpio_init(&gpio_h, drv));
+    h_init = TRUE;
+    EXEC_G(Bus::direction_output(&gpio_h, 0));
+
+    printf("Writing %d-bit bus on GPIO%d-%d\n", GPIO_BUS_WIDTH,
+        GPIO_BUS_FIRST, GPIO_BUS_FIRST+GPIO_BUS_WIDTH-1);
+
+    start = time_sec();
+    for (i=0; i<WORDS; i++) {
+        for (b=0; b<GPIO_BUS_WIDTH; b++)
+            gpio_set_value(&gpio_h, GPIO_BUS_FIRST+b, (i>>b)&1);
+    }
+    print_res("gpio_set_value()", "word", WORDS, time_sec()-start);
+
+    start = time_sec();
+    for (i=0; i<WORDS; i++)
+        gpio_write_bank(&gpio_h, GPIO_BUS_MASK, (uint64_t)i<<GPIO_BUS_FIRST);
+    print_res("gpio_write_bank()", "word", WORDS, time_sec()-start);
+
+    start = time_sec();
+    for (i=0; i<WORDS; i++) {
+        gpio_io_write_bank_fast(
+            &gpio_h, GPIO_BUS_MASK, (uint64_t)i<<GPIO_BUS_FIRST);
+    }
+    print_res("gpio_io_write_bank_fast()", "word", WORDS, time_sec()-start);
+
+    start = time_sec();
+    for (i=0; i<WORDS; i++)
+        Bus::write(&gpio_h, i);
+    print_res("Port<>::write()", "word", WORDS, time_sec()-start);
+
+    printf("Toggling GPIO%d\n", GPIO_BUS_FIRST);
+
+    start = time_sec();
+    for (i=0; i<TOGGLES; i++)
+        gpio_set_value(&gpio_h, GPIO_BUS_FIRST, i&1);
+    print_res("gpio_set_value()", "toggle", TOGGLES, time_sec()-start);
+
+    start = time_sec();
+    for (i=0; i<TOGGLES; i++)
+        gpio_io_set_fast(&gpio_h, GPIO_BUS_FIRST, i&1);
+    print_res("gpio_io_set_fast()", "toggle", TOGGLES, time_sec()-start);
+
+    start = time_sec();
+    for (i=0; i<TOGGLES; i++)
+        Tgl::write(&gpio_h, i&1);
+    print_res("Pin<>::write()", "toggle", TOGGLES, time_sec()-start);
+
+finish:
+    if (h_init) {
+        /* protect the out pins */
+        Bus::direction_input(&gpio_h);
+        gpio_free(&gpio_h);
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO input/output test (CDEV version).
+
+   Drives GPIO_OUT_FIRST..GPIO_OUT_FIRST+3 outputs with a counter and reads
+   them back together with GPIO_IN (pulled up) input via multi-line get/set.
+   Usage:
+
+     gpio_cdev [gpiochip-dev]
+
+   The example may be run on any Linux box with the gpio-sim kernel module
+   (see README.md for details).
+ */
+
+#include <stdio.h>
+#include "librasp/gpio.h"
+
+#define GPIO_OUT_FIRST  4
+#define GPIO_IN         22
+
+#define GPIO_OUTS   (0x0fULL<<GPIO_OUT_FIRST)
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE;
+    gpio_hndl_t gpio_h;
+    unsigned int i, gpio;
+    uint64_t levs;
+
+    /* don't open default chip on init */
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_sysfs));
+    h_init = TRUE;
+
+    if (argc>1) EXEC_G(gpio_cdev_set_chip(&gpio_h, argv[1]));
+    EXEC_G(gpio_set_driver(&gpio_h, gpio_drv_cdev));
+
+    /* request all lines at once */
+    EXEC_G(gpio_cdev_request(&gpio_h, GPIO_OUTS|GPIO_MASK(GPIO_IN)));
+    EXEC_G(gpio_cdev_set_config(
+        &gpio_h, GPIO_MASK(GPIO_IN), GPIO_CDEV_BIAS_PULL_UP));
+
+    for (gpio=GPIO_OUT_FIRST; gpio<GPIO_OUT_FIRST+4; gpio++)
+        EXEC_G(gpio_direction_output(&gpio_h, gpio, 0));
+
+    for (i=0; i<16; i++) {
+        EXEC_G(gpio_write_bank(&gpio_h, GPIO_OUTS, (uint64_t)i<<GPIO_OUT_FIRST));
+        EXEC_G(gpio_read_bank(&gpio_h, GPIO_OUTS|GPIO_MASK(GPIO_IN), &levs));
+
+        printf("out: 0x%x, read-back: 0x%x, GPIO%d: %d\n", i,
+            (unsigned int)gpio_bank_extract(levs, GPIO_OUTS),
+            GPIO_IN, GPIO_LEV(levs, GPIO_IN));
+    }
+
+    /* protect the out pins */
+    for (gpio=GPIO_OUT_FIRST; gpio<GPIO_OUT_FIRST+4; gpio++)
+        gpio_direction_input(&gpio_h, gpio);
+
+finish:
+    if (h_init) gpio_free(&gpio_h);
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO input debounce.
+
+   Connect a button between GPIO_IN (pulled up) and the ground. The example
+   prints debounced button presses/releases filtered by the debounce engine
+   (1kHz sampling, 10ms stable-count filter) together with the engine
+   statistics.
+ */
+
+#include <stdio.h>
+#include "librasp/gpio_dbnc.h"
+
+#define GPIO_IN         22
+
+#define DBNC_RATE       1000
+#define DBNC_N          10
+#define POLL_TIMEOUT    10000
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+int main(void)
+{
+    bool_t h_init=FALSE, d_init=FALSE;
+    gpio_hndl_t gpio_h;
+    gpio_dbnc_t dbnc;
+    gpio_dbnc_stats_t stats;
+    gpio_event_t evs[16];
+    size_t i, n_evs;
+
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_io));
+    h_init = TRUE;
+
+    EXEC_G(gpio_direction_input(&gpio_h, GPIO_IN));
+    EXEC_G(gpio_bcm_set_pull_config(&gpio_h, GPIO_IN, gpio_bcm_pull_up));
+
+    EXEC_G(gpio_dbnc_init(&dbnc, &gpio_h, DBNC_RATE, ARRAY_SZ(evs)));
+    d_init = TRUE;
+    EXEC_G(gpio_dbnc_add(&dbnc, GPIO_IN, gpio_dbnc_stable, DBNC_N));
+    EXEC_G(gpio_dbnc_start(&dbnc));
+
+    printf("Waiting for button on GPIO%d (%d seconds timeout)\n",
+        GPIO_IN, POLL_TIMEOUT/1000);
+
+    while (gpio_dbnc_read_events(&dbnc,
+        evs, ARRAY_SZ(evs), &n_evs, POLL_TIMEOUT)==LREC_SUCCESS)
+    {
+        for (i=0; i<n_evs; i++) {
+            printf("  [%llu.%06llu] button %s\n",
+                (unsigned long long)(evs[i].ts/1000000000U),
+                (unsigned long long)(evs[i].ts%1000000000U)/1000,
+                (evs[i].event==GPIO_EVENT_FALLING ? "pressed" : "released"));
+        }
+    }
+
+    gpio_dbnc_stop(&dbnc);
+    gpio_dbnc_get_stats(&dbnc, &stats);
+    printf("Sampling ticks: %llu, missed: %llu, events: %llu, dropped: %llu\n",
+        (unsigned long long)stats.n_ticks, (unsigned long long)stats.n_overruns,
+        (unsigned long long)stats.n_events, (unsigned long long)stats.n_dropped);
+
+finish:
+    if (d_init) gpio_dbnc_free(&dbnc);
+    if (h_init) gpio_free(&gpio_h);
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Reading GPIO edge events stream (CDEV version).
+
+   Prints pulse widths of a signal connected to GPIO_IN as reconstructed from
+   the kernel timestamped edge events. The events are read in batches, there
+   is no need for the real-time priority. Usage:
+
+     gpio_events [gpiochip-dev]
+ */
+
+#include <stdio.h>
+#include "librasp/gpio.h"
+
+#define GPIO_IN         22
+
+/* kernel events buffer size */
+#define EVENTS_BUF      1024
+#define POLL_TIMEOUT    10000
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE;
+    gpio_hndl_t gpio_h;
+    gpio_event_t evs[64];
+    size_t i, n_evs;
+    uint64_t last_ts=0;
+    uint32_t next_seqno=0;
+
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_sysfs));
+    h_init = TRUE;
+
+    if (argc>1) EXEC_G(gpio_cdev_set_chip(&gpio_h, argv[1]));
+    EXEC_G(gpio_set_driver(&gpio_h, gpio_drv_cdev));
+
+    EXEC_G(gpio_cdev_set_event_buf(&gpio_h, EVENTS_BUF));
+    EXEC_G(gpio_cdev_request(&gpio_h, GPIO_MASK(GPIO_IN)));
+    EXEC_G(gpio_set_event(&gpio_h, GPIO_IN, GPIO_EVENT_BOTH));
+
+    printf("Waiting for events on GPIO%d (%d seconds timeout)\n",
+        GPIO_IN, POLL_TIMEOUT/1000);
+
+    while (gpio_cdev_read_events(&gpio_h,
+        evs, ARRAY_SZ(evs), &n_evs, POLL_TIMEOUT)==LREC_SUCCESS)
+    {
+        for (i=0; i<n_evs; i++)
+        {
+            if (next_seqno && evs[i].seqno!=next_seqno)
+                printf("  %u events lost\n", evs[i].seqno-next_seqno);
+            next_seqno = evs[i].seqno+1;
+
+            if (last_ts) {
+                printf("  %s pulse: %llu ns\n",
+                    (evs[i].event==GPIO_EVENT_RAISING ? "low" : "high"),
+                    (unsigned long long)(evs[i].ts-last_ts));
+            }
+            last_ts = evs[i].ts;
+        }
+    }
+
+finish:
+    if (h_init) gpio_free(&gpio_h);
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO event loop wake-up latency and CPU cost benchmark.
+
+   Connect GPIO_OUT with GPIO_IN. The benchmark toggles GPIO_OUT and measures
+   time elapsed until gpio_evloop_wait() returns with GPIO_IN event, while
+   1, 8 and all available GPIOs are watched by the loop (the additional GPIOs
+   are idle). Usage:
+
+     gpio_evloop_bench [sysfs|cdev [gpiochip-dev]]
+
+   NOTE: All GPIOs except GPIO_OUT are configured as inputs for the time of
+   the benchmark.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "librasp/gpio_evloop.h"
+
+#define GPIO_OUT    27
+#define GPIO_IN     22
+
+#define ITERS       1000
+#define TIMEOUT     1000
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+static uint64_t time_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
+}
+
+static uint64_t cpu_ns(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (uint64_t)(ru.ru_utime.tv_sec+ru.ru_stime.tv_sec)*1000000000LL +
+        (uint64_t)(ru.ru_utime.tv_usec+ru.ru_stime.tv_usec)*1000LL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x=*(const uint64_t*)a, y=*(const uint64_t*)b;
+    return (x>y)-(x<y);
+}
+
+/* Set up 'gpio' to be watched; return FALSE if not possible */
+static bool_t setup_gpio(gpio_hndl_t *p_gpio_h, unsigned int gpio)
+{
+    if (p_gpio_h->drv==gpio_drv_sysfs) {
+        if (gpio_sysfs_export(p_gpio_h, gpio)!=LREC_SUCCESS) return FALSE;
+    } else {
+        if (gpio_cdev_request(p_gpio_h, GPIO_MASK(gpio))!=LREC_SUCCESS)
+            return FALSE;
+    }
+    return (gpio_direction_input(p_gpio_h, gpio)==LREC_SUCCESS &&
+        gpio_set_event(p_gpio_h, gpio, GPIO_EVENT_BOTH)==LREC_SUCCESS);
+}
+
+static void bench(gpio_evloop_t *p_loop, unsigned int n_watched)
+{
+    unsigned int i, n_lost=0;
+    uint64_t ready, start, cpu, lats[ITERS];
+
+    cpu = cpu_ns();
+    for (i=0; i<ITERS; i++)
+    {
+        start = time_ns();
+        gpio_set_value(p_loop->p_gpio_h, GPIO_OUT, !(i&1));
+
+        do {
+            if (gpio_evloop_wait(p_loop, TIMEOUT, &ready)!=LREC_SUCCESS) {
+                n_lost++;
+                break;
+            }
+        } while (!(ready & GPIO_MASK(GPIO_IN)));
+
+        lats[i] = time_ns()-start;
+    }
+    cpu = cpu_ns()-cpu;
+
+    qsort(lats, ITERS, sizeof(lats[0]), cmp_u64);
+    printf("  %2u watched: latency [us] min:%.1f, p50:%.1f, p99:%.1f, "
+        "max:%.1f; CPU/wake-up: %.1f us; lost: %u\n", n_watched,
+        lats[0]/1e3, lats[ITERS/2]/1e3, lats[ITERS*99/100]/1e3,
+        lats[ITERS-1]/1e3, cpu/1e3/ITERS, n_lost);
+}
+
+int main(int argc, char **argv)
+{
+    static const unsigned int n_watch[] = {1, 8, GPIO_NUM};
+
+    bool_t h_init=FALSE, l_init=FALSE;
+    gpio_hndl_t gpio_h;
+    gpio_evloop_t loop;
+    gpio_driver_t drv=gpio_drv_sysfs;
+    unsigned int i, gpio, n_watched;
+    uint64_t exported=0;
+
+    if (argc>1) {
+        if (!strcmp(argv[1], "cdev")) drv=gpio_drv_cdev;
+        else
+        if (strcmp(argv[1], "sysfs")) {
+            printf("Usage: %s [sysfs|cdev [gpiochip-dev]]\n", argv[0]);
+            goto finish;
+        }
+    }
+
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_sysfs));
+    h_init = TRUE;
+    if (drv==gpio_drv_cdev) {
+        if (argc>2) EXEC_G(gpio_cdev_set_chip(&gpio_h, argv[2]));
+        EXEC_G(gpio_set_driver(&gpio_h, gpio_drv_cdev));
+        EXEC_G(gpio_cdev_request(&gpio_h, GPIO_MASK(GPIO_OUT)));
+    } else {
+        EXEC_G(gpio_sysfs_export(&gpio_h, GPIO_OUT));
+        exported |= GPIO_MASK(GPIO_OUT);
+    }
+    EXEC_G(gpio_direction_output(&gpio_h, GPIO_OUT, 0));
+
+    EXEC_G(gpio_evloop_init(&loop, &gpio_h));
+    l_init = TRUE;
+
+    if (drv==gpio_drv_sysfs) exported |= GPIO_MASK(GPIO_IN);
+    if (!setup_gpio(&gpio_h, GPIO_IN)) goto finish;
+    EXEC_G(gpio_evloop_add(&loop, GPIO_IN, NULL, NULL));
+    n_watched = 1;
+
+    printf("Wake-up latency of GPIO%d -> GPIO%d loop-back (%s driver)\n",
+        GPIO_OUT, GPIO_IN, (drv==gpio_drv_sysfs ? "SYSFS" : "CDEV"));
+
+    for (i=0, gpio=0; i<ARRAY_SZ(n_watch); i++)
+    {
+        for (; n_watched<n_watch[i] && gpio<GPIO_NUM; gpio++)
+        {
+            if (gpio==GPIO_OUT || gpio==GPIO_IN) continue;
+            if (drv==gpio_drv_sysfs) exported |= GPIO_MASK(gpio);
+            if (!setup_gpio(&gpio_h, gpio)) continue;
+            if (gpio_evloop_add(&loop, gpio, NULL, NULL)==LREC_SUCCESS)
+                n_watched++;
+        }
+        bench(&loop, n_watched);
+    }
+
+finish:
+    if (l_init) gpio_evloop_free(&loop);
+    if (h_init) {
+        /* protect the out pin */
+        gpio_direction_input(&gpio_h, GPIO_OUT);
+        for (gpio=0; gpio<GPIO_NUM; gpio++) {
+            if (exported & GPIO_MASK(gpio)) {
+                gpio_set_event(&gpio_h, gpio, GPIO_EVENT_NONE);
+                gpio_sysfs_unexport(&gpio_h, gpio);
+            }
+        }
+        gpio_free(&gpio_h);
+    }
+    return 0;
+}
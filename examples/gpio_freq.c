@@ -0,0 +1,122 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO pulse counter and frequency meter.
+
+   Connect a pulses source to GPIO_IN. The example counts raising edges on the
+   GPIO and prints the counter readings (pulses count, frequency over 1 sec
+   sliding window) every 0.5 sec. Usage:
+
+     gpio_freq [cdev|bcm|sim]
+
+   cdev (default) counts edge events of the CDEV driver, bcm polls BCM's event
+   detect status registers (the library must be configured with
+   CONFIG_BCM_GPIO_EVENTS), sim is the bcm variant run off-target on the BCM
+   simulator with 1kHz square wave generated on GPIO_IN.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "librasp/gpio_cnt.h"
+#include "librasp/sim.h"
+
+#define GPIO_IN     22
+
+#define BCM_RATE    20000
+#define FREQ_WIN    1000
+#define N_READS     20
+
+/* simulated square wave period [us] */
+#define SIM_PERIOD  1000
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+/* simulator waveform callback */
+static uint64_t sim_wave(void *arg,
+    uint64_t tick, uint64_t outs, uint64_t out_levs, uint64_t *p_drv)
+{
+    *p_drv = GPIO_MASK(GPIO_IN);
+    return ((tick/(SIM_PERIOD/2))&1 ? GPIO_MASK(GPIO_IN) : 0);
+}
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE, c_init=FALSE, sim=FALSE;
+    gpio_hndl_t gpio_h;
+    gpio_cnt_t cnt;
+    gpio_cnt_stat_t stat;
+    gpio_cnt_src_t src = gpio_cnt_cdev;
+    unsigned int i;
+    lr_errc_t ret;
+
+    if (argc>1) {
+        if (!strcmp(argv[1], "bcm")) src = gpio_cnt_bcm;
+        else if (!strcmp(argv[1], "sim")) { src = gpio_cnt_bcm; sim = TRUE; }
+    }
+
+    if (src==gpio_cnt_cdev) {
+        EXEC_G(gpio_init(&gpio_h, gpio_drv_sysfs));
+        h_init = TRUE;
+        EXEC_G(gpio_set_driver(&gpio_h, gpio_drv_cdev));
+        EXEC_G(gpio_cdev_request(&gpio_h, GPIO_MASK(GPIO_IN)));
+    } else {
+        EXEC_G(gpio_init(&gpio_h, (sim ? gpio_drv_sim : gpio_drv_io)));
+        h_init = TRUE;
+        EXEC_G(gpio_direction_input(&gpio_h, GPIO_IN));
+    }
+
+    if (sim) {
+        EXEC_G(sim_set_wave(sim_wave, NULL));
+        EXEC_G(sim_start(SIM_PERIOD/20));
+    }
+
+    if ((ret=gpio_cnt_init(&cnt, &gpio_h, src, BCM_RATE, FREQ_WIN))
+        !=LREC_SUCCESS)
+    {
+        if (ret==LREC_NOT_SUPP) {
+            printf("BCM events counting not supported; the library must be "
+                "configured with CONFIG_BCM_GPIO_EVENTS\n");
+        }
+        goto finish;
+    }
+    c_init = TRUE;
+    EXEC_G(gpio_cnt_add(&cnt, GPIO_IN, GPIO_EVENT_RAISING));
+    EXEC_G(gpio_cnt_start(&cnt));
+
+    printf("Counting pulses on GPIO%d (%s)\n", GPIO_IN,
+        (src==gpio_cnt_cdev ? "cdev" : (sim ? "sim" : "bcm")));
+
+    for (i=0; i<N_READS; i++)
+    {
+        usleep(500000);
+        EXEC_G(gpio_cnt_read(&cnt, GPIO_IN, &stat));
+
+        printf("  pulses: %llu, freq: %.3f Hz, span: %.6f s\n",
+            (unsigned long long)stat.count, stat.freq,
+            (stat.last_ts-stat.first_ts)/1e9);
+    }
+
+    gpio_cnt_stop(&cnt);
+    printf("Reads: %llu, missed polls: %llu, errors: %llu\n",
+        (unsigned long long)cnt.n_reads, (unsigned long long)cnt.n_overruns,
+        (unsigned long long)cnt.n_errs);
+
+finish:
+    if (sim) {
+        sim_stop();
+        sim_set_wave(NULL, NULL);
+    }
+    if (c_init) gpio_cnt_free(&cnt);
+    if (h_init) gpio_free(&gpio_h);
+    return 0;
+}
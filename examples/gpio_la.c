@@ -0,0 +1,107 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO logic analyzer.
+
+   Captures GPIOs levels (GPIO_DEFS by default) for a given time after a level
+   change on the first of the captured GPIOs and writes the capture as VCD file
+   (to be opened by PulseView or GTKWave). Usage:
+
+     gpio_la out.vcd [time-ms [max-rate-hz [gpio ...]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "librasp/gpio_la.h"
+
+#define GPIO_DEFS   {17, 22, 27}
+
+#define N_RECS      (1024*1024)
+#define N_PRETRIG   16
+#define TRIG_TIMEOUT 10000000U
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+int main(int argc, char **argv)
+{
+    static const unsigned int gpio_defs[] = GPIO_DEFS;
+
+    bool_t gh_init=FALSE, ch_init=FALSE, la_init=FALSE;
+    gpio_hndl_t gpio_h;
+    clock_hndl_t clk_h;
+    gpio_la_t la;
+    gpio_la_cfg_t cfg;
+    FILE *f=NULL;
+    int i;
+    unsigned int trig_gpio;
+    lr_errc_t ret;
+
+    if (argc<2) {
+        printf("Usage: %s out.vcd [time-ms [max-rate-hz [gpio ...]]]\n",
+            argv[0]);
+        goto finish;
+    }
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.duration = (argc>2 ? (uint32_t)atoi(argv[2]) : 100)*1000U;
+    cfg.max_rate = (argc>3 ? (uint32_t)atoi(argv[3]) : 0);
+
+    if (argc>4) {
+        trig_gpio = (unsigned int)atoi(argv[4]);
+        for (i=4; i<argc; i++) cfg.mask |= GPIO_MASK(atoi(argv[i]));
+    } else {
+        trig_gpio = gpio_defs[0];
+        for (i=0; i<(int)ARRAY_SZ(gpio_defs); i++)
+            cfg.mask |= GPIO_MASK(gpio_defs[i]);
+    }
+
+    cfg.trig = gpio_la_trig_change;
+    cfg.trig_mask = GPIO_MASK(trig_gpio);
+    cfg.trig_timeout = TRIG_TIMEOUT;
+    cfg.n_pretrig = N_PRETRIG;
+
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_io));
+    gh_init = TRUE;
+    EXEC_G(clock_init(&clk_h, clock_drv_io));
+    ch_init = TRUE;
+    EXEC_G(gpio_la_init(&la, &gpio_h, &clk_h, N_RECS));
+    la_init = TRUE;
+
+    printf("Waiting for trigger on GPIO%u (%u seconds timeout)\n",
+        trig_gpio, TRIG_TIMEOUT/1000000U);
+
+    ret = gpio_la_capture(&la, &cfg);
+    if (ret==LREC_TIMEOUT) {
+        printf("Trigger timeout\n");
+        goto finish;
+    } else EXEC_G(ret);
+
+    printf("Captured %u records; samples: %llu, rate: %u Hz, dropped: %llu, "
+        "max gap: %u us%s\n", (unsigned int)la.count,
+        (unsigned long long)la.stats.n_samples, la.stats.rate,
+        (unsigned long long)la.stats.n_dropped, la.stats.max_gap,
+        (la.stats.overflow ? ", OVERFLOW" : ""));
+
+    if (!(f = fopen(argv[1], "w"))) {
+        printf("Can't open %s\n", argv[1]);
+        goto finish;
+    }
+    EXEC_G(gpio_la_export_vcd(&la, f));
+
+finish:
+    if (f) fclose(f);
+    if (la_init) gpio_la_free(&la);
+    if (ch_init) clock_free(&clk_h);
+    if (gh_init) gpio_free(&gpio_h);
+    return 0;
+}
@@ -0,0 +1,326 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO edge to user space wake-up latency benchmark.
+
+   Connect GPIO_OUT with GPIO_IN. The benchmark toggles GPIO_OUT (via the I/O
+   driver) in random intervals and measures time elapsed until a waiter thread
+   detects the edge on GPIO_IN by:
+   - busy polling GPLEVn (gpio_get_value() of the I/O driver),
+   - polling BCM's event detect status GPEDSn (gpio_bcm_get_event_stat(); the
+     library must be configured with CONFIG_BCM_GPIO_EVENTS),
+   - gpio_sysfs_poll() of the SYSFS driver,
+   - gpio_cdev_read_events() of the CDEV driver (if configured).
+   The time is taken from the STC [us] at the edge generation and the waiter's
+   wake-up. For each method latency percentiles and histogram (log2 buckets)
+   are printed. With "sim" argument the benchmark is run off-target on the
+   BCM simulator with GPIO_OUT looped back to GPIO_IN (the kernel based
+   methods are not available then). Usage:
+
+     gpio_latency [sim] [gpiochip-dev]
+
+   NOTE: GPIO_OUT is configured as output for the time of the benchmark.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "librasp/clock.h"
+#include "librasp/gpio.h"
+#include "librasp/sim.h"
+
+#define GPIO_OUT    27
+#define GPIO_IN     22
+
+#define ITERS       2000
+
+/* edges interval: EDGE_INTV + rand(EDGE_INTV) [us] */
+#define EDGE_INTV   1000
+
+/* edge detection timeout [ms] */
+#define TIMEOUT     100
+
+/* histogram buckets: [0,1), [1,2), [2,4), ..., [2^(HIST_N-2),inf) [us] */
+#define HIST_N      18
+#define HIST_BAR    40
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+typedef enum _method_t
+{
+    meth_gplev=0,
+    meth_gpeds,
+    meth_sysfs,
+    meth_cdev
+} method_t;
+
+static const char *meth_names[] = {
+    "GPLEV busy poll", "GPEDS poll", "sysfs poll", "cdev events"
+};
+
+/* edge waiter thread context */
+static struct {
+    method_t meth;
+    gpio_hndl_t *p_gpio_h;  /* handle of the method's driver */
+    clock_hndl_t *p_clk_h;
+
+    bool_t run;
+    unsigned int n_wakes;   /* number of detected edges */
+    uint32_t wake_ts;       /* last edge detection STC time */
+} wtr;
+
+static void wtr_wake(void)
+{
+    uint32_t ts=0;
+
+    clock_get_ticks32(wtr.p_clk_h, &ts);
+    __atomic_store_n(&wtr.wake_ts, ts, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&wtr.n_wakes, 1, __ATOMIC_RELEASE);
+}
+
+static void *wtr_thrd(void *arg)
+{
+    unsigned int lev=0, cur;
+    size_t n_read;
+    gpio_event_t evs[4];
+
+    if (wtr.meth==meth_gplev) gpio_get_value(wtr.p_gpio_h, GPIO_IN, &lev);
+
+    while (__atomic_load_n(&wtr.run, __ATOMIC_ACQUIRE))
+    {
+        switch (wtr.meth)
+        {
+        case meth_gplev:
+            if (gpio_get_value(wtr.p_gpio_h, GPIO_IN, &cur)==LREC_SUCCESS &&
+                cur!=lev)
+            {
+                wtr_wake();
+                lev = cur;
+            }
+            break;
+
+        case meth_gpeds:
+            if (gpio_bcm_get_event_stat(
+                wtr.p_gpio_h, GPIO_IN, &cur)==LREC_SUCCESS && cur)
+            {
+                wtr_wake();
+            }
+            break;
+
+        case meth_sysfs:
+            if (gpio_sysfs_poll(wtr.p_gpio_h, GPIO_IN, TIMEOUT)==LREC_SUCCESS)
+                wtr_wake();
+            break;
+
+        case meth_cdev:
+            if (gpio_cdev_read_events(wtr.p_gpio_h, evs, ARRAY_SZ(evs),
+                &n_read, TIMEOUT)==LREC_SUCCESS && n_read>0)
+            {
+                wtr_wake();
+            }
+            break;
+        }
+    }
+    return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x=*(const uint32_t*)a, y=*(const uint32_t*)b;
+    return (x>y)-(x<y);
+}
+
+static void print_res(uint32_t *p_lats, unsigned int n, unsigned int n_lost)
+{
+    unsigned int i, b, max_cnt=0, hist[HIST_N];
+
+    if (!n) {
+        printf("  no edges detected; lost: %u\n", n_lost);
+        return;
+    }
+
+    qsort(p_lats, n, sizeof(*p_lats), cmp_u32);
+    printf("  latency [us] min:%u, p50:%u, p90:%u, p99:%u, p99.9:%u, max:%u; "
+        "jitter [us] p99-p50:%u, p-p:%u; lost: %u\n", p_lats[0], p_lats[n/2],
+        p_lats[n*90/100], p_lats[n*99/100], p_lats[n*999/1000], p_lats[n-1],
+        p_lats[n*99/100]-p_lats[n/2], p_lats[n-1]-p_lats[0], n_lost);
+
+    memset(hist, 0, sizeof(hist));
+    for (i=0; i<n; i++) {
+        for (b=0; b<HIST_N-1 && (p_lats[i]>>b); b++);
+        hist[b]++;
+    }
+    for (b=0; b<HIST_N; b++) max_cnt = MAX(max_cnt, hist[b]);
+
+    for (b=0; b<HIST_N; b++)
+    {
+        if (!hist[b]) continue;
+
+        if (!b) printf("  %13s", "0");
+        else if (b<HIST_N-1) printf("  %6u-%-6u", 1U<<(b-1), (1U<<b)-1);
+        else printf("  %6u+%6s", 1U<<(b-1), "");
+
+        printf(" %5u |", hist[b]);
+        for (i=0; i<(hist[b]*HIST_BAR+max_cnt-1)/max_cnt; i++) putchar('#');
+        putchar('\n');
+    }
+}
+
+/* Measure latency of the waiter method; edges are generated on 'p_out_h' */
+static void bench(method_t meth, gpio_hndl_t *p_gpio_h,
+    gpio_hndl_t *p_out_h, clock_hndl_t *p_clk_h)
+{
+    static uint32_t lats[ITERS];
+
+    unsigned int i, n=0, n_lost=0, n_wakes, waited;
+    uint32_t start;
+    pthread_t thrd;
+
+    printf("%s:\n", meth_names[meth]);
+
+    wtr.meth = meth;
+    wtr.p_gpio_h = p_gpio_h;
+    wtr.p_clk_h = p_clk_h;
+    wtr.run = TRUE;
+    wtr.n_wakes = 0;
+
+    if (pthread_create(&thrd, NULL, wtr_thrd, NULL)) {
+        printf("  waiter thread creation error\n");
+        return;
+    }
+    /* let the waiter settle */
+    usleep(10000);
+
+    for (i=0; i<ITERS; i++)
+    {
+        usleep(EDGE_INTV + rand()%EDGE_INTV);
+
+        n_wakes = __atomic_load_n(&wtr.n_wakes, __ATOMIC_ACQUIRE);
+        clock_get_ticks32(p_clk_h, &start);
+        gpio_set_value(p_out_h, GPIO_OUT, !(i&1));
+
+        for (waited=0; waited<TIMEOUT*10 &&
+            __atomic_load_n(&wtr.n_wakes, __ATOMIC_ACQUIRE)==n_wakes; waited++)
+        {
+            usleep(100);
+        }
+
+        if (__atomic_load_n(&wtr.n_wakes, __ATOMIC_ACQUIRE)!=n_wakes) {
+            uint32_t lat =
+                __atomic_load_n(&wtr.wake_ts, __ATOMIC_RELAXED)-start;
+            /* spurious wake-up before the edge */
+            if ((int32_t)lat>=0) lats[n++]=lat; else n_lost++;
+        } else
+            n_lost++;
+    }
+
+    __atomic_store_n(&wtr.run, FALSE, __ATOMIC_RELEASE);
+    pthread_join(thrd, NULL);
+
+    print_res(lats, n, n_lost);
+}
+
+/* simulator waveform callback: GPIO_OUT looped back to GPIO_IN */
+static uint64_t sim_loopback(void *arg,
+    uint64_t tick, uint64_t outs, uint64_t out_levs, uint64_t *p_drv)
+{
+    *p_drv = GPIO_MASK(GPIO_IN);
+    return ((out_levs>>GPIO_OUT)&1) ? GPIO_MASK(GPIO_IN) : 0;
+}
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE, ch_init=FALSE, sim=FALSE, exprt=FALSE;
+    bool_t sh_init=FALSE, dh_init=FALSE;
+    const char *chip=NULL;
+    int i;
+    gpio_hndl_t gpio_h, sysfs_h, cdev_h;
+    clock_hndl_t clk_h;
+
+    for (i=1; i<argc; i++) {
+        if (!strcmp(argv[i], "sim")) sim = TRUE;
+        else chip = argv[i];
+    }
+
+    EXEC_G(gpio_init(&gpio_h, (sim ? gpio_drv_sim : gpio_drv_io)));
+    h_init = TRUE;
+    EXEC_G(clock_init(&clk_h, (sim ? clock_drv_sim : clock_drv_io)));
+    ch_init = TRUE;
+
+    if (sim) EXEC_G(sim_set_wave(sim_loopback, NULL));
+
+    EXEC_G(gpio_direction_output(&gpio_h, GPIO_OUT, 0));
+    EXEC_G(gpio_direction_input(&gpio_h, GPIO_IN));
+
+    printf("Edge to wake-up latency of GPIO%d -> GPIO%d loop-back%s\n",
+        GPIO_OUT, GPIO_IN, (sim ? " (simulated)" : ""));
+
+    bench(meth_gplev, &gpio_h, &gpio_h, &clk_h);
+
+    if (gpio_set_event(&gpio_h, GPIO_IN, GPIO_EVENT_BOTH)==LREC_SUCCESS) {
+        bench(meth_gpeds, &gpio_h, &gpio_h, &clk_h);
+        gpio_set_event(&gpio_h, GPIO_IN, GPIO_EVENT_NONE);
+    } else
+        printf("%s:\n  not supported\n", meth_names[meth_gpeds]);
+
+    if (sim) goto finish;
+
+    /* SYSFS driver */
+    if (gpio_init(&sysfs_h, gpio_drv_sysfs)==LREC_SUCCESS)
+    {
+        sh_init = exprt = TRUE;
+        if (gpio_sysfs_export_many(&sysfs_h, GPIO_MASK(GPIO_IN), TIMEOUT*10)
+                ==LREC_SUCCESS &&
+            gpio_direction_input(&sysfs_h, GPIO_IN)==LREC_SUCCESS &&
+            gpio_set_event(&sysfs_h, GPIO_IN, GPIO_EVENT_BOTH)==LREC_SUCCESS)
+        {
+            bench(meth_sysfs, &sysfs_h, &gpio_h, &clk_h);
+        } else
+            printf("%s:\n  not available\n", meth_names[meth_sysfs]);
+
+        gpio_set_event(&sysfs_h, GPIO_IN, GPIO_EVENT_NONE);
+        gpio_sysfs_unexport(&sysfs_h, GPIO_IN);
+        exprt = FALSE;
+    }
+
+    /* CDEV driver */
+    if (gpio_init(&cdev_h, gpio_drv_sysfs)==LREC_SUCCESS)
+    {
+        dh_init = TRUE;
+        if ((!chip || gpio_cdev_set_chip(&cdev_h, chip)==LREC_SUCCESS) &&
+            gpio_set_driver(&cdev_h, gpio_drv_cdev)==LREC_SUCCESS &&
+            gpio_cdev_request(&cdev_h, GPIO_MASK(GPIO_IN))==LREC_SUCCESS &&
+            gpio_direction_input(&cdev_h, GPIO_IN)==LREC_SUCCESS &&
+            gpio_set_event(&cdev_h, GPIO_IN, GPIO_EVENT_BOTH)==LREC_SUCCESS)
+        {
+            bench(meth_cdev, &cdev_h, &gpio_h, &clk_h);
+        } else
+            printf("%s:\n  not available\n", meth_names[meth_cdev]);
+    }
+
+finish:
+    if (dh_init) gpio_free(&cdev_h);
+    if (sh_init) {
+        if (exprt) gpio_sysfs_unexport(&sysfs_h, GPIO_IN);
+        gpio_free(&sysfs_h);
+    }
+    if (sim) sim_set_wave(NULL, NULL);
+    if (ch_init) clock_free(&clk_h);
+    if (h_init) {
+        /* protect the out pin */
+        gpio_direction_input(&gpio_h, GPIO_OUT);
+        gpio_free(&gpio_h);
+    }
+    return 0;
+}
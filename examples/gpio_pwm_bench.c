@@ -0,0 +1,91 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Software PWM engine jitter and CPU load benchmark.
+
+   Runs the PWM engine with 1, 4, 8 and 16 channels (GPIOs from PWM_GPIOS)
+   with different duty cycles and reports edges jitter and the engine thread
+   CPU load for each channels count. Usage:
+
+     gpio_pwm_bench [period-us [run-time-s]]
+
+   NOTE: The PWM_GPIOS are configured as outputs for the time of the benchmark.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "librasp/gpio_pwm.h"
+
+#define PWM_GPIOS   {4, 5, 6, 12, 13, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 27}
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+int main(int argc, char **argv)
+{
+    static const unsigned int gpios[] = PWM_GPIOS;
+    static const unsigned int n_chans[] = {1, 4, 8, 16};
+
+    bool_t gh_init=FALSE, ch_init=FALSE, pwm_init=FALSE;
+    gpio_hndl_t gpio_h;
+    clock_hndl_t clk_h;
+    gpio_pwm_t pwm;
+    gpio_pwm_stats_t stats;
+    unsigned int i, j, period, run_time;
+    uint64_t outs=0;
+
+    period = (argc>1 ? (unsigned int)atoi(argv[1]) : 1000);
+    run_time = (argc>2 ? (unsigned int)atoi(argv[2]) : 2);
+
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_io));
+    gh_init = TRUE;
+    EXEC_G(clock_init(&clk_h, clock_drv_io));
+    ch_init = TRUE;
+    EXEC_G(gpio_pwm_init(&pwm, &gpio_h, &clk_h, period));
+    pwm_init = TRUE;
+
+    for (i=0; i<ARRAY_SZ(gpios); i++) outs |= GPIO_MASK(gpios[i]);
+    EXEC_G(gpio_clr_mask(&gpio_h, outs));
+    EXEC_G(gpio_bcm_set_func_mask(&gpio_h, outs, gpio_bcm_out));
+
+    printf("PWM period: %u us, run time: %u s\n", period, run_time);
+
+    for (i=0; i<ARRAY_SZ(n_chans); i++)
+    {
+        for (j=0; j<n_chans[i]; j++) {
+            EXEC_G(gpio_pwm_set_duty(&pwm, gpios[j],
+                (j+1)*GPIO_PWM_DUTY_RES/(n_chans[i]+1)));
+        }
+
+        EXEC_G(gpio_pwm_start(&pwm));
+        sleep(run_time);
+        gpio_pwm_stop(&pwm);
+        gpio_pwm_get_stats(&pwm, &stats);
+
+        printf("  %2u channels: edges: %llu, jitter [us] avg:%.2f, max:%u; "
+            "overruns: %llu; CPU load: %.1f%%%s\n", n_chans[i],
+            (unsigned long long)stats.n_edges,
+            (stats.n_edges ? (double)stats.sum_jitter/stats.n_edges : 0.),
+            stats.max_jitter, (unsigned long long)stats.n_overruns,
+            stats.cpu_load/10., (pwm.rt ? "" : " (non-RT)"));
+    }
+
+finish:
+    if (pwm_init) gpio_pwm_free(&pwm);
+    if (gh_init) {
+        /* protect the out pins */
+        gpio_bcm_set_func_mask(&gpio_h, outs, gpio_bcm_in);
+        gpio_free(&gpio_h);
+    }
+    if (ch_init) clock_free(&clk_h);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Bit-bang micro-sequencer.
+
+   The example runs two sequencer programs:
+   - HC-SR04 distance sensor probe (trigger pulse, echo pulse time-stamping)
+     with the sensor connected to TRIG_GPIO, ECHO_GPIO,
+   - burst of BURST_N pulses on BURST_GPIO generated with the maximum
+     achievable edge rate,
+   and prints their results and timing reports. With "sim" argument the
+   example is run off-target on the BCM simulator with the sensor simulated
+   by the waveform callback (SIM_DIST cm distance). Usage:
+
+     gpio_seq [sim]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "librasp/gpio_seq.h"
+#include "librasp/sim.h"
+
+#define TRIG_GPIO   17
+#define ECHO_GPIO   18
+#define BURST_GPIO  27
+
+#define BURST_N     1000
+
+/* max echo response delay and echo pulse time [us] */
+#define ECHO_DELAY  1000
+#define ECHO_MAX    38000
+#define CM_PULSE    58
+
+/* simulated distance [cm] */
+#define SIM_DIST    123
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+/* simulated sensor */
+static struct {
+    bool_t trig;
+    uint64_t echo_start;
+} sens;
+
+/* simulator waveform callback */
+static uint64_t sens_wave(void *arg,
+    uint64_t tick, uint64_t outs, uint64_t out_levs, uint64_t *p_drv)
+{
+    bool_t trig = ((out_levs & GPIO_MASK(TRIG_GPIO))!=0);
+
+    /* echo starts 200us after the trigger pulse end */
+    if (sens.trig && !trig) sens.echo_start = tick+200;
+    sens.trig = trig;
+
+    *p_drv = GPIO_MASK(ECHO_GPIO);
+    return (sens.echo_start && tick>=sens.echo_start &&
+        tick<sens.echo_start+SIM_DIST*CM_PULSE ? GPIO_MASK(ECHO_GPIO) : 0);
+}
+
+static void print_report(const char *name, const gpio_seq_report_t *p_rep)
+{
+    printf("%s: elapsed: %u us, ops: %llu, samples: %u, late waits: %u "
+        "(max %u us)\n", name, p_rep->elapsed, (unsigned long long)p_rep->n_ops,
+        (unsigned int)p_rep->n_samples, p_rep->n_late, p_rep->max_late);
+}
+
+int main(int argc, char **argv)
+{
+    bool_t gh_init=FALSE, ch_init=FALSE, sim=(argc>1 && !strcmp(argv[1], "sim"));
+    gpio_hndl_t gpio_h;
+    clock_hndl_t clk_h;
+    gpio_seq_t probe, burst;
+    gpio_seq_report_t rep;
+    uint64_t stamps[2];
+    lr_errc_t ret;
+
+    /* sequences are init'ed first for gpio_seq_free() on error */
+    memset(&probe, 0, sizeof(probe));
+    memset(&burst, 0, sizeof(burst));
+
+    EXEC_G(gpio_init(&gpio_h, (sim ? gpio_drv_sim : gpio_drv_io)));
+    gh_init = TRUE;
+    EXEC_G(clock_init(&clk_h, (sim ? clock_drv_sim : clock_drv_io)));
+    ch_init = TRUE;
+
+    if (sim) EXEC_G(sim_set_wave(sens_wave, NULL));
+
+    EXEC_G(gpio_direction_output(&gpio_h, TRIG_GPIO, 0));
+    EXEC_G(gpio_direction_input(&gpio_h, ECHO_GPIO));
+    EXEC_G(gpio_direction_output(&gpio_h, BURST_GPIO, 0));
+
+    /* HC-SR04 probe: 10us trigger pulse, echo pulse start/end stamps */
+    EXEC_G(gpio_seq_init(&probe, 8));
+    gpio_seq_set(&probe, GPIO_MASK(TRIG_GPIO));
+    gpio_seq_wait(&probe, 10);
+    gpio_seq_clr(&probe, GPIO_MASK(TRIG_GPIO));
+    gpio_seq_wait_lev(&probe,
+        GPIO_MASK(ECHO_GPIO), GPIO_MASK(ECHO_GPIO), ECHO_DELAY);
+    gpio_seq_stamp(&probe);
+    gpio_seq_wait_lev(&probe, GPIO_MASK(ECHO_GPIO), 0, ECHO_MAX);
+    gpio_seq_stamp(&probe);
+    EXEC_G(gpio_seq_compile(&probe, NULL));
+
+    /* pulses burst */
+    EXEC_G(gpio_seq_init(&burst, 5));
+    gpio_seq_loop(&burst, BURST_N);
+    gpio_seq_set(&burst, GPIO_MASK(BURST_GPIO));
+    gpio_seq_clr(&burst, GPIO_MASK(BURST_GPIO));
+    gpio_seq_endloop(&burst);
+    EXEC_G(gpio_seq_compile(&burst, NULL));
+
+    ret = gpio_seq_run(&probe, &gpio_h, &clk_h, stamps, ARRAY_SZ(stamps), &rep);
+    if (ret==LREC_SUCCESS) {
+        printf("Distance: %u cm\n",
+            (unsigned int)((stamps[1]-stamps[0])/CM_PULSE));
+    } else {
+        printf("Probe error %d (op %d)\n", ret, rep.fail_op);
+    }
+    print_report("Probe", &rep);
+
+    EXEC_G(gpio_seq_run(&burst, &gpio_h, &clk_h, NULL, 0, &rep));
+    print_report("Burst", &rep);
+    if (rep.elapsed) {
+        printf("Burst edge rate: %.3f MHz\n",
+            (double)(2*BURST_N)/rep.elapsed);
+    }
+
+finish:
+    gpio_seq_free(&burst);
+    gpio_seq_free(&probe);
+    sim_set_wave(NULL, NULL);
+    if (ch_init) clock_free(&clk_h);
+    if (gh_init) gpio_free(&gpio_h);
+    return 0;
+}
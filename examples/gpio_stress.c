@@ -0,0 +1,264 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Concurrent GPIO configuration stress test.
+
+   1 to MAX_THREADS threads (each with its own GPIO handle) concurrently
+   reconfigure their own, interleaved GPIOs of GPIO_FIRST..GPIO_FIRST+11 range,
+   so the GPIOs of different threads share the same GPFSELn, event detect
+   enable and pulls configuration registers. Each thread switches its GPIOs
+   between input and output, sets their levels, rising edge detection (if
+   the library is configured with CONFIG_BCM_GPIO_EVENTS) and pulls (BCM2711
+   only), and verifies the GPIOs configuration before each update. Any
+   mismatch means an update lost due to a concurrent read-modify-write of a
+   shared register. The throughput (API calls per second) scaling with the
+   threads number is reported. With "sim" argument the test is run off-target
+   on the BCM simulator. Usage:
+
+     gpio_stress [sim]
+
+   NOTE: The tested GPIOs are switched to outputs during the test. Make sure
+   nothing is connected to them which may be harmed. The GPIOs configuration
+   (except pulls on pre-BCM2711 SoCs) is restored at the test end.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "librasp/gpio.h"
+
+#define GPIO_FIRST  16
+#define MAX_THREADS 4
+#define GPIO_CNT    (3*MAX_THREADS)
+
+#define ITERS       20000
+
+/* pulls are reconfigured every PULL_EVERY iteration */
+#define PULL_EVERY  16
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+static bool_t sim=FALSE, events=FALSE, pulls=FALSE;
+
+typedef struct _thrd_ctx_t
+{
+    unsigned int id;
+    pthread_t thrd;
+    gpio_hndl_t gpio_h;
+    unsigned long n_ops;
+    unsigned long n_lost;
+} thrd_ctx_t;
+
+/* expected GPIO configuration */
+typedef struct _gpio_cfg_t
+{
+    gpio_bcm_func_t func;
+    unsigned int lev;
+    bool_t rise;
+    gpio_bcm_pull_t pull;
+} gpio_cfg_t;
+
+static double time_sec(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (double)tp.tv_sec + (double)tp.tv_nsec/1e9;
+}
+
+static uint32_t reg_read(gpio_hndl_t *p_gpio_h, uint32_t reg)
+{
+    return *IO_REG32_PTR(p_gpio_h->io.p_gpio_io, reg);
+}
+
+/* BCM2711 pull configuration of 'gpio' */
+static gpio_bcm_pull_t get_pull(gpio_hndl_t *p_gpio_h, unsigned int gpio)
+{
+    uint32_t fld = (reg_read(p_gpio_h, GPIO_PUP_PDN_CNTRL_REG0+
+        sizeof(uint32_t)*(gpio/16))>>(2*(gpio%16)))&3;
+    return (fld==1 ? gpio_bcm_pull_up :
+        (fld==2 ? gpio_bcm_pull_down : gpio_bcm_pull_off));
+}
+
+/* Verify 'gpio' configuration; return number of mismatches */
+static unsigned int verify(
+    gpio_hndl_t *p_gpio_h, unsigned int gpio, gpio_cfg_t *p_cfg)
+{
+    unsigned int n=0, lev;
+    gpio_bcm_func_t func;
+
+    gpio_bcm_get_func(p_gpio_h, gpio, &func);
+    if (func!=p_cfg->func) {
+        p_cfg->func = func;
+        n++;
+    }
+    if (func==gpio_bcm_out) {
+        gpio_get_value(p_gpio_h, gpio, &lev);
+        if (lev!=p_cfg->lev) n++;
+    }
+    if (events && ((reg_read(p_gpio_h,
+        GPREN0+sizeof(uint32_t)*(gpio>>5))>>(gpio&0x1f))&1)!=p_cfg->rise)
+    {
+        p_cfg->rise = !p_cfg->rise;
+        n++;
+    }
+    if (pulls && get_pull(p_gpio_h, gpio)!=p_cfg->pull) {
+        p_cfg->pull = get_pull(p_gpio_h, gpio);
+        n++;
+    }
+    return n;
+}
+
+static void *stress_thrd(void *arg)
+{
+    thrd_ctx_t *p_ctx = (thrd_ctx_t*)arg;
+    gpio_hndl_t *p_gpio_h = &p_ctx->gpio_h;
+    gpio_cfg_t cfgs[GPIO_CNT/MAX_THREADS];
+    unsigned int i, j, gpio;
+
+    memset(cfgs, 0, sizeof(cfgs));
+    for (j=0; j<ARRAY_SZ(cfgs); j++) {
+        gpio = GPIO_FIRST+p_ctx->id+j*MAX_THREADS;
+        gpio_bcm_get_func(p_gpio_h, gpio, &cfgs[j].func);
+        gpio_get_value(p_gpio_h, gpio, &cfgs[j].lev);
+        if (events) gpio_set_event(p_gpio_h, gpio, GPIO_EVENT_NONE);
+        if (pulls) cfgs[j].pull = get_pull(p_gpio_h, gpio);
+    }
+
+    for (i=0; i<ITERS; i++)
+    {
+        for (j=0; j<ARRAY_SZ(cfgs); j++)
+        {
+            gpio_cfg_t *p_cfg = &cfgs[j];
+            gpio = GPIO_FIRST+p_ctx->id+j*MAX_THREADS;
+
+            p_ctx->n_lost += verify(p_gpio_h, gpio, p_cfg);
+
+            if (p_cfg->func==gpio_bcm_out) {
+                gpio_direction_input(p_gpio_h, gpio);
+                p_cfg->func = gpio_bcm_in;
+            } else {
+                p_cfg->lev = (i>>1)&1;
+                gpio_direction_output(p_gpio_h, gpio, p_cfg->lev);
+                p_cfg->func = gpio_bcm_out;
+            }
+            p_ctx->n_ops++;
+
+            if (events) {
+                p_cfg->rise = !p_cfg->rise;
+                gpio_set_event(p_gpio_h, gpio,
+                    (p_cfg->rise ? GPIO_EVENT_RAISING : GPIO_EVENT_NONE));
+                p_ctx->n_ops++;
+            }
+
+            if (pulls && !(i%PULL_EVERY)) {
+                p_cfg->pull = (p_cfg->pull==gpio_bcm_pull_up ?
+                    gpio_bcm_pull_down : gpio_bcm_pull_up);
+                gpio_bcm_set_pull_config(p_gpio_h, gpio, p_cfg->pull);
+                p_ctx->n_ops++;
+            }
+        }
+    }
+
+    for (j=0; j<ARRAY_SZ(cfgs); j++) {
+        gpio = GPIO_FIRST+p_ctx->id+j*MAX_THREADS;
+        p_ctx->n_lost += verify(p_gpio_h, gpio, &cfgs[j]);
+    }
+    return NULL;
+}
+
+/* Run the stress test with 'n_thrds' threads; return the throughput */
+static double stress(unsigned int n_thrds, double base)
+{
+    unsigned int i, n_init=0, n_started=0;
+    unsigned long n_ops=0, n_lost=0;
+    double start, time, ops_sec=0.;
+    thrd_ctx_t ctxs[MAX_THREADS];
+
+    memset(ctxs, 0, sizeof(ctxs));
+    for (; n_init<n_thrds; n_init++) {
+        ctxs[n_init].id = n_init;
+        if (gpio_init(&ctxs[n_init].gpio_h,
+            (sim ? gpio_drv_sim : gpio_drv_io))!=LREC_SUCCESS) goto finish;
+    }
+
+    start = time_sec();
+    for (; n_started<n_thrds; n_started++) {
+        if (pthread_create(&ctxs[n_started].thrd,
+            NULL, stress_thrd, &ctxs[n_started])) break;
+    }
+    for (i=0; i<n_started; i++) {
+        pthread_join(ctxs[i].thrd, NULL);
+        n_ops += ctxs[i].n_ops;
+        n_lost += ctxs[i].n_lost;
+    }
+    time = time_sec()-start;
+
+    if (n_started==n_thrds) {
+        ops_sec = n_ops/time;
+        printf("  %u thread(s): %lu calls in %.3f sec; %.0f calls/sec, "
+            "speedup: %.2f; lost updates: %lu\n", n_thrds, n_ops, time,
+            ops_sec, (base ? ops_sec/base : 1.), n_lost);
+    } else
+        printf("  %u thread(s): threads creation error\n", n_thrds);
+
+finish:
+    for (i=0; i<n_init; i++) gpio_free(&ctxs[i].gpio_h);
+    return ops_sec;
+}
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE, c_saved=FALSE;
+    unsigned int i;
+    double base=0.;
+    gpio_hndl_t gpio_h;
+    gpio_bcm_ctx_t ctx;
+    gpio_bcm_pull_t pull_ctx[GPIO_CNT];
+
+    sim = (argc>1 && !strcmp(argv[1], "sim"));
+
+    EXEC_G(gpio_init(&gpio_h, (sim ? gpio_drv_sim : gpio_drv_io)));
+    h_init = TRUE;
+    EXEC_G(gpio_bcm_save_ctx(&gpio_h, &ctx));
+    c_saved = TRUE;
+
+    events = (gpio_set_event(
+        &gpio_h, GPIO_FIRST, GPIO_EVENT_NONE)==LREC_SUCCESS);
+    pulls = (gpio_h.io.plat==bcm_2711);
+    if (pulls) {
+        for (i=0; i<GPIO_CNT; i++)
+            pull_ctx[i] = get_pull(&gpio_h, GPIO_FIRST+i);
+    }
+
+    printf("Concurrent configuration of GPIO%d-%d (%ld CPUs online); "
+        "events: %s, pulls: %s\n", GPIO_FIRST, GPIO_FIRST+GPIO_CNT-1,
+        sysconf(_SC_NPROCESSORS_ONLN), (events ? "yes" : "no"),
+        (pulls ? "yes" : "no"));
+
+    for (i=1; i<=MAX_THREADS; i++) {
+        double ops_sec = stress(i, base);
+        if (i==1) base = ops_sec;
+    }
+
+finish:
+    if (c_saved) {
+        gpio_bcm_restore_ctx(&gpio_h, &ctx);
+        if (pulls) {
+            for (i=0; i<GPIO_CNT; i++)
+                gpio_bcm_set_pull_config(&gpio_h, GPIO_FIRST+i, pull_ctx[i]);
+        }
+    }
+    if (h_init) gpio_free(&gpio_h);
+    return 0;
+}
@@ -0,0 +1,282 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* DMA paced GPIO waveform.
+
+   The example:
+   - verifies the DMA control blocks chain of a test waveform against the DMA
+     controller model (no hardware involved),
+   - generates a square wave on GPIO_OUT by DMA paced waveform, then by a CPU
+     thread (the baseline) toggling the GPIO with the real-time scheduler,
+   and reports the square wave period jitter measured by polling the GPIO
+   level for each method,
+   - runs a one-shot pulse waveform several times (restart of the finished
+     one-shot waveform).
+   With "sim" argument the example is run off-target
+   on the BCM simulator (the DMA is emulated by a CPU thread then). Usage:
+
+     gpio_wave [sim] [pcm]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "librasp/gpio_wave.h"
+
+#define GPIO_OUT    18
+
+/* square wave half period [ns] */
+#define HALF_PERIOD 50000
+
+/* measurement time [ns] */
+#define MEAS_TIME   1000000000LL
+
+#define DMA_CH      5
+
+/* one-shot pulse: steps number and runs */
+#define PULSE_STEPS 4
+#define PULSE_RUNS  3
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+static uint64_t time_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
+}
+
+/* DMA model check: GPIOs latch sampled at each step start */
+typedef struct _chk_t
+{
+    uint32_t latch;
+    size_t n_steps;
+    uint32_t levs[16];
+} chk_t;
+
+static bool_t chk_wr(void *arg, uint32_t bus, uint32_t val)
+{
+    chk_t *p_chk = (chk_t*)arg;
+
+    if (bus==BCM_PERI_BUS_BASE+GPIO_BASE_RA+GPSET0) {
+        p_chk->latch |= val;
+    } else
+    if (bus==BCM_PERI_BUS_BASE+GPIO_BASE_RA+GPCLR0) {
+        p_chk->latch &= ~val;
+    } else {
+        /* pacing write starts the next step; the latch after the previous */
+        if (p_chk->n_steps) p_chk->levs[p_chk->n_steps-1] = p_chk->latch;
+        if (++p_chk->n_steps > ARRAY_SZ(p_chk->levs)) return FALSE;
+    }
+    return TRUE;
+}
+
+/* Verify looped 4-bits counter waveform on GPIO 0-3 */
+static bool_t chk_chain(void)
+{
+    static uint8_t buf[1024] __attribute__((aligned(32)));
+
+    size_t i;
+    chk_t chk;
+    gpio_wave_mem_t mem;
+    gpio_wave_step_t steps[8];
+
+    for (i=0; i<ARRAY_SZ(steps); i++) {
+        steps[i].set = (uint32_t)i;
+        steps[i].clr = (uint32_t)~i & 0x0f;
+    }
+
+    mem.p_virt = buf;
+    mem.bus = 0xc0000000;
+    mem.size = sizeof(buf);
+    mem.mb_hndl = 0;
+
+    memset(&chk, 0, sizeof(chk));
+    if (gpio_wave_build(&mem, steps, ARRAY_SZ(steps), gpio_wave_pace_pwm, TRUE)
+        !=LREC_SUCCESS) return FALSE;
+    gpio_wave_dma_exec(&mem, mem.bus, 0, chk_wr, &chk, NULL);
+
+    for (i=0; i<ARRAY_SZ(chk.levs); i++)
+        if (chk.levs[i]!=i%ARRAY_SZ(steps)) return FALSE;
+    return TRUE;
+}
+
+/* square wave period statistics [ns] */
+typedef struct _jitter_t
+{
+    unsigned long n;
+    double sum;
+    double sum_dev;         /* sum of deviations from the nominal period */
+    uint64_t min, max;
+} jitter_t;
+
+/* Measure square wave period on GPIO_OUT */
+static void measure(gpio_hndl_t *p_gpio_h, jitter_t *p_jit)
+{
+    unsigned int lev, prev=0;
+    uint64_t now, start=time_ns(), last=0;
+
+    memset(p_jit, 0, sizeof(*p_jit));
+    p_jit->min = (uint64_t)-1;
+
+    do {
+        gpio_get_value(p_gpio_h, GPIO_OUT, &lev);
+        now = time_ns();
+
+        if (lev && !prev) {
+            if (last) {
+                uint64_t t = now-last;
+                p_jit->n++;
+                p_jit->sum += t;
+                p_jit->sum_dev +=
+                    (t>2*HALF_PERIOD ? t-2*HALF_PERIOD : 2*HALF_PERIOD-t);
+                p_jit->min = MIN(p_jit->min, t);
+                p_jit->max = MAX(p_jit->max, t);
+            }
+            last = now;
+        }
+        prev = lev;
+    } while (now-start < MEAS_TIME);
+}
+
+static void print_jitter(const char *name, const jitter_t *p_jit)
+{
+    if (!p_jit->n) {
+        printf("%s: no edges detected\n", name);
+        return;
+    }
+    printf("%s: periods: %lu, avg: %.3f us, min: %.3f us, max: %.3f us, "
+        "p-p jitter: %.3f us, mean abs deviation: %.3f us\n", name, p_jit->n,
+        p_jit->sum/p_jit->n/1000, p_jit->min/1000., p_jit->max/1000.,
+        (p_jit->max-p_jit->min)/1000., p_jit->sum_dev/p_jit->n/1000);
+}
+
+/* Run loaded one-shot pulse waveform 'n' times; return number of the runs
+   with the pulse detected on GPIO_OUT */
+static unsigned int run_pulses(
+    gpio_hndl_t *p_gpio_h, gpio_wave_t *p_wave, unsigned int n)
+{
+    unsigned int i, lev, n_det=0;
+    bool_t high;
+    uint64_t start;
+
+    for (i=0; i<n; i++)
+    {
+        if (gpio_wave_start(p_wave)!=LREC_SUCCESS) break;
+
+        start = time_ns();
+        high = FALSE;
+        do {
+            gpio_get_value(p_gpio_h, GPIO_OUT, &lev);
+            if (lev) high = TRUE;
+        } while (gpio_wave_busy(p_wave) && time_ns()-start < MEAS_TIME);
+
+        if (high) n_det++;
+    }
+    return n_det;
+}
+
+/* CPU driven square wave (baseline) */
+static struct {
+    gpio_hndl_t *p_gpio_h;
+    bool_t run;
+} cpu_wave;
+
+static void *cpu_wave_thrd(void *arg)
+{
+    unsigned int lev=0;
+    uint64_t next = time_ns();
+    struct timespec tp;
+    sched_rt_t sched_h;
+
+    sched_rt_raise_max(&sched_h);
+
+    while (__atomic_load_n(&cpu_wave.run, __ATOMIC_ACQUIRE))
+    {
+        next += HALF_PERIOD;
+        tp.tv_sec = next/1000000000U;
+        tp.tv_nsec = next%1000000000U;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tp, NULL);
+
+        lev ^= 1;
+        gpio_set_value(cpu_wave.p_gpio_h, GPIO_OUT, lev);
+    }
+
+    sched_restore(&sched_h);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    bool_t h_init=FALSE, w_init=FALSE, sim=FALSE;
+    int i;
+    gpio_hndl_t gpio_h;
+    gpio_wave_t wave;
+    gpio_wave_step_t steps[PULSE_STEPS];
+    gpio_wave_pace_t pace = gpio_wave_pace_pwm;
+    jitter_t jit;
+    pthread_t thrd;
+
+    for (i=1; i<argc; i++) {
+        if (!strcmp(argv[i], "sim")) sim = TRUE;
+        else if (!strcmp(argv[i], "pcm")) pace = gpio_wave_pace_pcm;
+    }
+
+    printf("Control blocks chain check: %s\n", (chk_chain() ? "OK" : "FAILED"));
+
+    EXEC_G(gpio_init(&gpio_h, (sim ? gpio_drv_sim : gpio_drv_io)));
+    h_init = TRUE;
+    EXEC_G(gpio_direction_output(&gpio_h, GPIO_OUT, 0));
+
+    /* DMA paced square wave */
+    steps[0].set = GPIO_MASK(GPIO_OUT);
+    steps[0].clr = 0;
+    steps[1].set = 0;
+    steps[1].clr = GPIO_MASK(GPIO_OUT);
+
+    EXEC_G(gpio_wave_init(
+        &wave, &gpio_h, pace, DMA_CH, HALF_PERIOD, ARRAY_SZ(steps)));
+    w_init = TRUE;
+    EXEC_G(gpio_wave_load(&wave, steps, 2, TRUE));
+    EXEC_G(gpio_wave_start(&wave));
+
+    measure(&gpio_h, &jit);
+    gpio_wave_stop(&wave);
+    print_jitter((pace==gpio_wave_pace_pwm ? "DMA (PWM paced)" :
+        "DMA (PCM paced)"), &jit);
+
+    /* CPU driven square wave */
+    cpu_wave.p_gpio_h = &gpio_h;
+    cpu_wave.run = TRUE;
+    if (!pthread_create(&thrd, NULL, cpu_wave_thrd, NULL)) {
+        measure(&gpio_h, &jit);
+        __atomic_store_n(&cpu_wave.run, FALSE, __ATOMIC_RELEASE);
+        pthread_join(thrd, NULL);
+        print_jitter("CPU (baseline)", &jit);
+    }
+
+    /* one-shot pulse; high for all but the last step */
+    memset(steps, 0, sizeof(steps));
+    steps[0].set = GPIO_MASK(GPIO_OUT);
+    steps[PULSE_STEPS-1].clr = GPIO_MASK(GPIO_OUT);
+
+    EXEC_G(gpio_set_value(&gpio_h, GPIO_OUT, 0));
+    EXEC_G(gpio_wave_load(&wave, steps, ARRAY_SZ(steps), FALSE));
+    printf("One-shot pulse: %u of %u runs detected\n",
+        run_pulses(&gpio_h, &wave, PULSE_RUNS), PULSE_RUNS);
+
+finish:
+    if (w_init) gpio_wave_free(&wave);
+    if (h_init) gpio_free(&gpio_h);
+    return 0;
+}
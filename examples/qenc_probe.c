@@ -0,0 +1,83 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* Quadrature encoders probe.
+
+   Prints counts, velocities and illegal transitions counters of encoders
+   connected to ENC_GPIOS (A/B pairs; pulled up inputs). Usage:
+
+     qenc_probe [sampling-rate-hz]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "librasp/devices/qenc.h"
+
+#define ENC_GPIOS   {{23, 24}, {5, 6}}
+
+#define VEL_WIN     100
+#define N_READS     60
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+int main(int argc, char **argv)
+{
+    static const unsigned int enc_gpios[][2] = ENC_GPIOS;
+
+    bool_t h_init=FALSE, q_init=FALSE;
+    gpio_hndl_t gpio_h;
+    qenc_t qenc;
+    unsigned int i, j, id;
+    uint32_t rate = (argc>1 ? (uint32_t)atoi(argv[1]) : 20000);
+
+    EXEC_G(gpio_init(&gpio_h, gpio_drv_io));
+    h_init = TRUE;
+
+    EXEC_G(qenc_init(&qenc, &gpio_h, rate, VEL_WIN));
+    q_init = TRUE;
+
+    for (i=0; i<ARRAY_SZ(enc_gpios); i++) {
+        for (j=0; j<2; j++) {
+            EXEC_G(gpio_direction_input(&gpio_h, enc_gpios[i][j]));
+            EXEC_G(gpio_bcm_set_pull_config(
+                &gpio_h, enc_gpios[i][j], gpio_bcm_pull_up));
+        }
+        EXEC_G(qenc_add(&qenc, enc_gpios[i][0], enc_gpios[i][1], &id));
+    }
+
+    EXEC_G(qenc_start(&qenc));
+    printf("Sampling %u encoders with %u Hz%s\n", qenc.n_encs, rate,
+        (qenc.rt ? "" : " (non-RT)"));
+
+    for (i=0; i<N_READS; i++)
+    {
+        usleep(500000);
+
+        for (id=0; id<qenc.n_encs; id++) {
+            int64_t count;
+            int32_t vel;
+            uint64_t n_errs;
+
+            EXEC_G(qenc_read(&qenc, id, &count, &vel, &n_errs));
+            printf("%s enc%u: count: %lld, vel: %d/s, errs: %llu",
+                (id ? "," : ""), id, (long long)count, vel,
+                (unsigned long long)n_errs);
+        }
+        printf("; missed ticks: %llu\n", (unsigned long long)qenc.n_overruns);
+    }
+
+finish:
+    if (q_init) qenc_free(&qenc);
+    if (h_init) gpio_free(&gpio_h);
+    return 0;
+}
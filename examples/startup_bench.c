@@ -0,0 +1,104 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+/* GPIO/clock handles startup time benchmark.
+
+   Measures the first (cold) platform detection, the cached platform detection
+   and the I/O handles init/free cycle time with and without another handle
+   sharing the peripheral mapping. Usage:
+
+     startup_bench [io|gpio]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "librasp/gpio.h"
+#include "librasp/clock.h"
+
+#define ITERS   1000
+
+#define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
+
+static uint64_t time_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
+}
+
+/* GPIO handle init/free cycle time [us] */
+static double gpio_cycle(gpio_driver_t drv)
+{
+    unsigned int i;
+    gpio_hndl_t gpio_h;
+    uint64_t start = time_ns();
+
+    for (i=0; i<ITERS; i++) {
+        if (gpio_init(&gpio_h, drv)!=LREC_SUCCESS) return -1.;
+        gpio_free(&gpio_h);
+    }
+    return (time_ns()-start)/1e3/ITERS;
+}
+
+/* clock handle init/free cycle time [us] */
+static double clock_cycle(void)
+{
+    unsigned int i;
+    clock_hndl_t clk_h;
+    uint64_t start = time_ns();
+
+    for (i=0; i<ITERS; i++) {
+        if (clock_init(&clk_h, clock_drv_io)!=LREC_SUCCESS) return -1.;
+        clock_free(&clk_h);
+    }
+    return (time_ns()-start)/1e3/ITERS;
+}
+
+int main(int argc, char **argv)
+{
+    bool_t gh_init=FALSE, ch_init=FALSE;
+    gpio_hndl_t gpio_h;
+    clock_hndl_t clk_h;
+    gpio_driver_t drv=gpio_drv_io;
+    platform_t plat;
+    unsigned int i;
+    uint64_t start;
+
+    if (argc>1 && !strcmp(argv[1], "gpio")) drv=gpio_drv_gpio;
+
+    start = time_ns();
+    plat = platform_detect();
+    printf("Platform: %d, I/O base: 0x%08x\n", plat, get_bcm_io_base());
+    printf("  1st platform detection: %.1f us\n", (time_ns()-start)/1e3);
+
+    start = time_ns();
+    for (i=0; i<ITERS; i++) platform_detect();
+    printf("  cached platform detection: %.3f us\n", (time_ns()-start)/1e3/ITERS);
+
+    printf("  GPIO handle init/free: %.1f us\n", gpio_cycle(drv));
+    printf("  clock handle init/free: %.1f us\n", clock_cycle());
+
+    /* keep handles with mapped I/O; the mappings are shared */
+    EXEC_G(gpio_init(&gpio_h, drv));
+    gh_init = TRUE;
+    EXEC_G(clock_init(&clk_h, clock_drv_io));
+    ch_init = TRUE;
+
+    printf("  GPIO handle init/free (shared mapping): %.1f us\n", gpio_cycle(drv));
+    printf("  clock handle init/free (shared mapping): %.1f us\n", clock_cycle());
+
+finish:
+    if (ch_init) clock_free(&clk_h);
+    if (gh_init) gpio_free(&gpio_h);
+    return 0;
+}
@@ -22,6 +22,81 @@
 #define BCM_STC_MAP_LEN         PAGE_SZ
 #define BCM_DEF_USLEEP_THRSHD   400U
 
+/* drivers operations access (defined below) */
+static const clock_drv_ops_t *get_drv_ops(clock_driver_t drv);
+
+/* Number of timed operations per probed driver */
+#define PROBE_OPS   1000U
+
+/* built-in drivers probing results */
+static pthread_once_t drv_probe_once = PTHREAD_ONCE_INIT;
+static clock_drv_probe_t drv_probe;
+
+/* Probe a built-in driver; return its per-operation cost [ns] or 0 if the
+   driver is not available.
+ */
+static uint32_t probe_drv(clock_driver_t drv)
+{
+    clock_hndl_t hndl;
+    uint64_t start;
+    uint32_t ticks, cost=0;
+    unsigned int n=0;
+
+    /* quiet access path checks (no errors logged) */
+    if (drv==clock_drv_io &&
+        (!get_bcm_io_base() || access(DEV_MEM_IO, R_OK|W_OK))) goto finish;
+
+    if (clock_init(&hndl, drv)==LREC_SUCCESS)
+    {
+        start = time_ns();
+        for (; n<PROBE_OPS; n++) {
+            if (clock_get_ticks32(&hndl, &ticks)!=LREC_SUCCESS) break;
+        }
+        if (n) {
+            cost = (uint32_t)((time_ns()-start)/n);
+            if (!cost) cost=1;
+        }
+    }
+    clock_free(&hndl);
+finish:
+    return cost;
+}
+
+/* Probe the built-in drivers and select the fastest one.
+ */
+static void probe_drvs(void)
+{
+    static const clock_driver_t cands[] = {
+        clock_drv_io,
+#if CONFIG_CLOCK_SYS_DRIVER
+        clock_drv_sys
+#endif
+    };
+    unsigned int i;
+    uint32_t cost, best=0;
+
+    memset(&drv_probe, 0, sizeof(drv_probe));
+    drv_probe.drv = (clock_driver_t)-1;
+
+    for (i=0; i<ARRAY_SZ(cands); i++)
+    {
+        cost = drv_probe.costs[cands[i]] = probe_drv(cands[i]);
+
+        /* the later probed driver must be at least 10% faster */
+        if (cost && (!best || (uint64_t)cost*10 < (uint64_t)best*9)) {
+            drv_probe.drv = cands[i];
+            best = cost;
+        }
+    }
+}
+
+/* exported; see header for details */
+void clock_get_drv_probe(clock_drv_probe_t *p_probe)
+{
+    pthread_once(&drv_probe_once, probe_drvs);
+    *p_probe = drv_probe;
+}
+
 /* exported; see header for details */
 lr_errc_t clock_init(clock_hndl_t *p_hndl, clock_driver_t drv)
 {
@@ -33,8 +108,35 @@ lr_errc_t clock_init(clock_hndl_t *p_hndl, clock_driver_t drv)
 /* exported; see header for details */
 lr_errc_t clock_set_driver(clock_hndl_t *p_hndl, clock_driver_t drv)
 {
+    const clock_drv_ops_t *p_ops=NULL;
     lr_errc_t ret=LREC_SUCCESS;
 
+    if (drv==clock_drv_auto)
+    {
+        /* activate the fastest probed driver */
+        pthread_once(&drv_probe_once, probe_drvs);
+
+        if (drv_probe.drv!=(clock_driver_t)-1) {
+            ret = clock_set_driver(p_hndl, drv_probe.drv);
+        } else {
+            err_printf("[%s] No clock driver available\n", __func__);
+            ret=LREC_NOT_SUPP;
+        }
+        return ret;
+    }
+
+    if (drv>=clock_drv_custom && drv<CLOCK_DRV_MAX)
+    {
+        /* registered driver */
+        p_ops = get_drv_ops(drv);
+
+        if (!p_ops) {
+            ret=LREC_INV_ARG;
+        } else
+        if (drv!=p_hndl->drv && p_ops->init) {
+            ret = p_ops->init(p_hndl);
+        }
+    } else
     switch (drv)
     {
     default:
@@ -43,11 +145,15 @@ lr_errc_t clock_set_driver(clock_hndl_t *p_hndl, clock_driver_t drv)
 
     case clock_drv_io:
       {
+        if (p_hndl->io.sim) {
+            /* I/O attached to the simulator */
+            ret=LREC_NOT_SUPP;
+        } else
         if (!p_hndl->io.p_stc_io)
         {
             uint32_t io_base = get_bcm_io_base();
             if (io_base) {
-                if (!(p_hndl->io.p_stc_io = io_mmap(
+                if (!(p_hndl->io.p_stc_io = io_mmap_shared(
                     DEV_MEM_IO, io_base+ST_BASE_RA, BCM_STC_MAP_LEN)))
                 {
                     ret=LREC_MMAP_ERR;
@@ -67,11 +173,37 @@ lr_errc_t clock_set_driver(clock_hndl_t *p_hndl, clock_driver_t drv)
         /* no initialization needed in this case */
 #else
         ret=LREC_NOT_SUPP;
+#endif
+        break;
+
+    case clock_drv_sim:
+#if CONFIG_SIM_DRIVER
+        if (!p_hndl->io.p_stc_io) {
+            p_hndl->io.p_stc_io = sim_attach(FALSE);
+            p_hndl->io.sim = TRUE;
+        } else
+        if (!p_hndl->io.sim) {
+            /* I/O mapped to the real STC */
+            ret=LREC_NOT_SUPP;
+        }
+#else
+        ret=LREC_NOT_SUPP;
 #endif
         break;
     }
 
-    if (ret==LREC_SUCCESS) p_hndl->drv = drv;
+    if (ret==LREC_SUCCESS)
+    {
+        /* release the previously active registered driver */
+        if (p_hndl->drv!=drv && p_hndl->drv>=clock_drv_custom &&
+            p_hndl->drv<CLOCK_DRV_MAX && p_hndl->p_ops->free)
+        {
+            p_hndl->p_ops->free(p_hndl);
+        }
+
+        p_hndl->drv = drv;
+        p_hndl->p_ops = (p_ops ? p_ops : get_drv_ops(drv));
+    }
     return ret;
 }
 
@@ -80,14 +212,28 @@ void clock_free(clock_hndl_t *p_hndl)
 {
     if (p_hndl->drv!=(clock_driver_t)-1)
     {
+        /* free registered driver resources */
+        if (p_hndl->drv>=clock_drv_custom && p_hndl->drv<CLOCK_DRV_MAX &&
+            p_hndl->p_ops->free)
+        {
+            p_hndl->p_ops->free(p_hndl);
+        }
+
         /* free I/O driver resources */
         if (p_hndl->io.p_stc_io) {
-            munmap((void*)p_hndl->io.p_stc_io, BCM_STC_MAP_LEN);
+#if CONFIG_SIM_DRIVER
+            if (p_hndl->io.sim) {
+                sim_detach();
+                p_hndl->io.sim = FALSE;
+            } else
+#endif
+            io_munmap_shared(p_hndl->io.p_stc_io);
             p_hndl->io.p_stc_io = NULL;
         }
 
         /* mark the handle as closed */
         p_hndl->drv = (clock_driver_t)-1;
+        p_hndl->p_ops = NULL;
     }
 }
 
@@ -96,70 +242,46 @@ void clock_free(clock_hndl_t *p_hndl)
 #define get_bcm_clock_ticks_hi(h) \
     ((uint32_t)*IO_REG32_PTR((h)->io.p_stc_io, ST_CHI))
 
-/* exported; see header for details */
-lr_errc_t clock_get_ticks32(clock_hndl_t *p_hndl, uint32_t *p_ticks)
-{
-    lr_errc_t ret=LREC_SUCCESS;
-
-    if (p_hndl->drv==clock_drv_io) {
-        *p_ticks = get_bcm_clock_ticks_lo(p_hndl);
-    } else {
-#if CONFIG_CLOCK_SYS_DRIVER
-        struct timespec tp;
-        if (!clock_gettime(CLOCK_MONOTONIC, &tp)) {
-            *p_ticks = tp.tv_nsec;
-        } else {
-            err_printf("[%s] clock_gettime() error %d; %s\n",
-                __func__, errno, strerror(errno));
-            ret=LREC_CLK_ERR;
-        }
+/* Refresh simulated STC (if 'sim' is TRUE) before reading it. The argument is
+   expected to be a constant, so the I/O driver implementations below are free
+   of the simulator overhead.
+ */
+#if CONFIG_SIM_DRIVER
+# define STC_SYNC(sim) if (sim) sim_stc_update();
 #else
-        ret=LREC_NOT_SUPP;
+# define STC_SYNC(sim)
 #endif
-    }
-    return ret;
+
+static inline uint32_t bcm_get_ticks32(clock_hndl_t *p_hndl, bool_t sim)
+{
+    STC_SYNC(sim);
+    return get_bcm_clock_ticks_lo(p_hndl);
 }
 
-/* exported; see header for details */
-lr_errc_t clock_get_ticks64(clock_hndl_t *p_hndl, uint64_t *p_ticks)
+static inline uint64_t bcm_get_ticks64(clock_hndl_t *p_hndl, bool_t sim)
 {
-    lr_errc_t ret=LREC_SUCCESS;
+    register uint32_t chi, clo, chi2;
 
-    if (p_hndl->drv==clock_drv_io) {
-        register uint32_t chi2;
-        register uint32_t chi = get_bcm_clock_ticks_hi(p_hndl);
-        register uint32_t clo = get_bcm_clock_ticks_lo(p_hndl);
+    STC_SYNC(sim);
+    chi = get_bcm_clock_ticks_hi(p_hndl);
+    clo = get_bcm_clock_ticks_lo(p_hndl);
 
-        if ((chi2=get_bcm_clock_ticks_hi(p_hndl)) > chi) {
-            /* ST_CLO reg overflow */
-            clo = get_bcm_clock_ticks_lo(p_hndl);
-            chi = chi2;
-        }
-        *p_ticks = ((uint64_t)chi<<32)|clo;
-    } else {
-#if CONFIG_CLOCK_SYS_DRIVER
-        struct timespec tp;
-        if (!clock_gettime(CLOCK_MONOTONIC, &tp)) {
-            *p_ticks = (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
-        } else {
-            err_printf("[%s] clock_gettime() error %d; %s\n",
-                __func__, errno, strerror(errno));
-            ret=LREC_CLK_ERR;
-        }
-#else
-        ret=LREC_NOT_SUPP;
-#endif
+    if ((chi2=get_bcm_clock_ticks_hi(p_hndl)) > chi) {
+        /* ST_CLO reg overflow */
+        clo = get_bcm_clock_ticks_lo(p_hndl);
+        chi = chi2;
     }
-    return ret;
+    return ((uint64_t)chi<<32)|clo;
 }
 
 /* BCM specific usec sleep implementation.
  */
-static void bcm_usleep(clock_hndl_t *p_hndl, uint32_t usec, uint32_t thrshd)
+static inline void
+    bcm_usleep(clock_hndl_t *p_hndl, uint32_t usec, uint32_t thrshd, bool_t sim)
 {
     uint32_t ticks, stop, time;
 
-    ticks = get_bcm_clock_ticks_lo(p_hndl);
+    ticks = bcm_get_ticks32(p_hndl, sim);
     stop = ticks+usec;
 
     for (time=0; time<usec;)
@@ -171,7 +293,7 @@ static void bcm_usleep(clock_hndl_t *p_hndl, uint32_t usec, uint32_t thrshd)
             usleep((usec-time)>>1);
         }
 
-        delta = get_bcm_clock_ticks_lo(p_hndl)-ticks;
+        delta = bcm_get_ticks32(p_hndl, sim)-ticks;
         if (delta) {
             time = (time+delta<time ? (uint32_t)-1 : time+delta);
             ticks += delta;
@@ -179,23 +301,187 @@ static void bcm_usleep(clock_hndl_t *p_hndl, uint32_t usec, uint32_t thrshd)
     }
 }
 
-/* exported; see header for details */
-lr_errc_t clock_usleep(clock_hndl_t *p_hndl, uint32_t usec)
+/* I/O driver.
+ */
+static lr_errc_t io_get_ticks32(clock_hndl_t *p_hndl, uint32_t *p_ticks)
+{
+    *p_ticks = bcm_get_ticks32(p_hndl, FALSE);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t io_get_ticks64(clock_hndl_t *p_hndl, uint64_t *p_ticks)
 {
+    *p_ticks = bcm_get_ticks64(p_hndl, FALSE);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t io_usleep(clock_hndl_t *p_hndl, uint32_t usec)
+{
+    bcm_usleep(p_hndl, usec, BCM_DEF_USLEEP_THRSHD, FALSE);
+    return LREC_SUCCESS;
+}
+
+static const clock_drv_ops_t io_ops =
+{
+    .get_ticks32 = io_get_ticks32,
+    .get_ticks64 = io_get_ticks64,
+    .usleep = io_usleep
+};
+
+#if CONFIG_SIM_DRIVER
+/* SIM driver.
+ */
+static lr_errc_t iosim_get_ticks32(clock_hndl_t *p_hndl, uint32_t *p_ticks)
+{
+    *p_ticks = bcm_get_ticks32(p_hndl, TRUE);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t iosim_get_ticks64(clock_hndl_t *p_hndl, uint64_t *p_ticks)
+{
+    *p_ticks = bcm_get_ticks64(p_hndl, TRUE);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t iosim_usleep(clock_hndl_t *p_hndl, uint32_t usec)
+{
+    bcm_usleep(p_hndl, usec, BCM_DEF_USLEEP_THRSHD, TRUE);
+    return LREC_SUCCESS;
+}
+
+static const clock_drv_ops_t iosim_ops =
+{
+    .get_ticks32 = iosim_get_ticks32,
+    .get_ticks64 = iosim_get_ticks64,
+    .usleep = iosim_usleep
+};
+#endif /* CONFIG_SIM_DRIVER */
+
+#if CONFIG_CLOCK_SYS_DRIVER
+/* SYS driver.
+ */
+static lr_errc_t sys_get_ticks32(clock_hndl_t *p_hndl, uint32_t *p_ticks)
+{
+    struct timespec tp;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!clock_gettime(CLOCK_MONOTONIC, &tp)) {
+        /* low 32-bits of the 64-bit time (tv_nsec wraps each second) */
+        *p_ticks = (uint32_t)((uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec);
+    } else {
+        err_printf("[%s] clock_gettime() error %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_CLK_ERR;
+    }
+    return ret;
+}
+
+static lr_errc_t sys_get_ticks64(clock_hndl_t *p_hndl, uint64_t *p_ticks)
+{
+    struct timespec tp;
     lr_errc_t ret=LREC_SUCCESS;
 
-    if (p_hndl->drv==clock_drv_io) {
-        bcm_usleep(p_hndl, usec, BCM_DEF_USLEEP_THRSHD);
+    if (!clock_gettime(CLOCK_MONOTONIC, &tp)) {
+        *p_ticks = (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
     } else {
+        err_printf("[%s] clock_gettime() error %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_CLK_ERR;
+    }
+    return ret;
+}
+
+static lr_errc_t sys_usleep(clock_hndl_t *p_hndl, uint32_t usec)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (usleep(usec)) {
+        err_printf("[%s] usleep() error %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret = LREC_CLK_ERR;
+    }
+    return ret;
+}
+
+static const clock_drv_ops_t sys_ops =
+{
+    .get_ticks32 = sys_get_ticks32,
+    .get_ticks64 = sys_get_ticks64,
+    .usleep = sys_usleep
+};
+#endif /* CONFIG_CLOCK_SYS_DRIVER */
+
+/* Drivers operations indexed by the driver id; built-in drivers are followed by
+   the registered ones.
+ */
+static const clock_drv_ops_t *drvs[CLOCK_DRV_MAX] =
+{
+    [clock_drv_io] = &io_ops,
 #if CONFIG_CLOCK_SYS_DRIVER
-        if (usleep(usec)) {
-            err_printf("[%s] usleep() error %d; %s\n",
-                __func__, errno, strerror(errno));
-            ret = LREC_CLK_ERR;
-        }
-#else
-        ret=LREC_NOT_SUPP;
+    [clock_drv_sys] = &sys_ops,
+#endif
+#if CONFIG_SIM_DRIVER
+    [clock_drv_sim] = &iosim_ops,
 #endif
+};
+
+static pthread_mutex_t drvs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Get driver's operations (NULL if the driver is not present).
+ */
+static const clock_drv_ops_t *get_drv_ops(clock_driver_t drv)
+{
+    const clock_drv_ops_t *p_ops;
+
+    pthread_mutex_lock(&drvs_lock);
+    p_ops = drvs[drv];
+    pthread_mutex_unlock(&drvs_lock);
+    return p_ops;
+}
+
+/* exported; see header for details */
+lr_errc_t
+    clock_register_driver(const clock_drv_ops_t *p_ops, clock_driver_t *p_drv)
+{
+    unsigned int i;
+    lr_errc_t ret=LREC_NO_SPACE;
+
+    if (!p_ops->get_ticks32 || !p_ops->get_ticks64 || !p_ops->usleep) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+
+    pthread_mutex_lock(&drvs_lock);
+    for (i=clock_drv_custom; i<CLOCK_DRV_MAX; i++) {
+        if (!drvs[i]) {
+            drvs[i] = p_ops;
+            *p_drv = (clock_driver_t)i;
+            ret=LREC_SUCCESS;
+            break;
+        }
     }
+    pthread_mutex_unlock(&drvs_lock);
+finish:
     return ret;
 }
+
+/* exported; see header for details */
+lr_errc_t clock_get_ticks32(clock_hndl_t *p_hndl, uint32_t *p_ticks)
+{
+    return (!p_hndl->p_ops ? LREC_NOINIT :
+        p_hndl->p_ops->get_ticks32(p_hndl, p_ticks));
+}
+
+/* exported; see header for details */
+lr_errc_t clock_get_ticks64(clock_hndl_t *p_hndl, uint64_t *p_ticks)
+{
+    return (!p_hndl->p_ops ? LREC_NOINIT :
+        p_hndl->p_ops->get_ticks64(p_hndl, p_ticks));
+}
+
+/* exported; see header for details */
+lr_errc_t clock_usleep(clock_hndl_t *p_hndl, uint32_t usec)
+{
+    return (!p_hndl->p_ops ? LREC_NOINIT :
+        p_hndl->p_ops->usleep(p_hndl, usec));
+}
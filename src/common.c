@@ -12,6 +12,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -40,8 +41,9 @@ lr_logdst_t get_librasp_log_dest(void) { return log_dest; }
 void set_librasp_log_level(lr_loglev_t lev) { log_lev=lev; }
 lr_loglev_t get_librasp_log_level(void) { return log_lev; }
 
-/* exported; see header for details */
-platform_t platform_detect()
+/* Detect platform type by /proc/cpuinfo parsing.
+ */
+static platform_t cpuinfo_platform_detect(void)
 {
     platform_t plat=(platform_t)-1;
     FILE *f = fopen("/proc/cpuinfo", "r");
@@ -92,27 +94,81 @@ platform_t platform_detect()
     return plat;
 }
 
-/* exported; see header for details */
-uint32_t get_bcm_io_base()
+/* Read BCM SoC I/O peripherals base address from the device tree; 0 if not
+   available.
+ */
+static uint32_t dt_io_base(void)
 {
     uint32_t ret=0;
+    uint8_t buf[4];
+    FILE *f = fopen("/proc/device-tree/soc/ranges", "rb");
+
+    if (f)
+    {
+        /* the ranges cells are big-endian; the base (parent bus address) is
+           the 2nd cell or the 3rd one for 2 cells parent address (BCM2711) */
+        if (fseek(f, 4, SEEK_SET)==0 && fread(buf, 1, sizeof(buf), f)==sizeof(buf))
+        {
+            ret = ((uint32_t)buf[0]<<24)|((uint32_t)buf[1]<<16)|
+                ((uint32_t)buf[2]<<8)|buf[3];
+
+            if (!ret && fread(buf, 1, sizeof(buf), f)==sizeof(buf)) {
+                ret = ((uint32_t)buf[0]<<24)|((uint32_t)buf[1]<<16)|
+                    ((uint32_t)buf[2]<<8)|buf[3];
+            }
+        }
+        fclose(f);
+    }
+    return ret;
+}
+
+/* platform detection is performed once per process */
+static pthread_once_t plat_once = PTHREAD_ONCE_INIT;
+static platform_t plat_cached = (platform_t)-1;
+static uint32_t io_base_cached = 0;
+
+static void plat_init(void)
+{
+    uint32_t dt_base;
 
-    switch (platform_detect())
+    plat_cached = cpuinfo_platform_detect();
+
+    /* the device tree base is trusted for the recognized BCM SoCs only; other
+       ARM boards may provide the same DT node with unrelated peripherals */
+    switch (plat_cached)
     {
     case bcm_2708:
-        ret=BCM2708_PERI_BASE;
+        io_base_cached=BCM2708_PERI_BASE;
         break;
     case bcm_2709:
-        ret=BCM2709_PERI_BASE;
+        io_base_cached=BCM2709_PERI_BASE;
         break;
     case bcm_2710:
-        ret=BCM2710_PERI_BASE;
+        io_base_cached=BCM2710_PERI_BASE;
         break;
     case bcm_2711:
-        ret=BCM2711_PERI_BASE;
+        io_base_cached=BCM2711_PERI_BASE;
         break;
+    default:
+        /* not a BCM platform */
+        return;
     }
-    return ret;
+
+    if ((dt_base = dt_io_base())) io_base_cached = dt_base;
+}
+
+/* exported; see header for details */
+platform_t platform_detect()
+{
+    pthread_once(&plat_once, plat_init);
+    return plat_cached;
+}
+
+/* exported; see header for details */
+uint32_t get_bcm_io_base()
+{
+    pthread_once(&plat_once, plat_init);
+    return io_base_cached;
 }
 
 /* exported; see header for details */
@@ -239,7 +295,84 @@ volatile void *io_mmap(const char *dev, uint32_t io_base, uint32_t len)
     return ret;
 }
 
-#define RT_SCHED    SCHED_RR
+/* shared I/O mappings registry */
+typedef struct _io_map_t
+{
+    struct _io_map_t *p_next;
+
+    char dev[32];
+    uint32_t io_base;
+    uint32_t len;
+
+    volatile void *p_io;
+    unsigned int refs;
+} io_map_t;
+
+static io_map_t *p_io_maps = NULL;
+static pthread_mutex_t io_maps_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+/* exported; see header for details */
+volatile void *io_mmap_shared(const char *dev, uint32_t io_base, uint32_t len)
+{
+    io_map_t *p_map;
+    volatile void *ret = NULL;
+
+    pthread_mutex_lock(&io_maps_mtx);
+
+    for (p_map=p_io_maps; p_map; p_map=p_map->p_next) {
+        if (p_map->io_base==io_base && p_map->len==len &&
+            !strcmp(p_map->dev, dev)) break;
+    }
+
+    if (p_map) {
+        p_map->refs++;
+        ret = p_map->p_io;
+    } else
+    if (strlen(dev)<sizeof(p_map->dev))
+    {
+        if (!(p_map = (io_map_t*)malloc(sizeof(*p_map)))) {
+            err_printf("[%s] No memory\n", __func__);
+        } else
+        if (!(ret = io_mmap(dev, io_base, len))) {
+            free(p_map);
+        } else {
+            strcpy(p_map->dev, dev);
+            p_map->io_base = io_base;
+            p_map->len = len;
+            p_map->p_io = ret;
+            p_map->refs = 1;
+            p_map->p_next = p_io_maps;
+            p_io_maps = p_map;
+        }
+    } else {
+        err_printf("[%s] Device name too long: %s\n", __func__, dev);
+    }
+
+    pthread_mutex_unlock(&io_maps_mtx);
+    return ret;
+}
+
+/* exported; see header for details */
+void io_munmap_shared(volatile void *p_io)
+{
+    io_map_t *p_map, **pp_map;
+
+    pthread_mutex_lock(&io_maps_mtx);
+
+    for (pp_map=&p_io_maps; (p_map=*pp_map); pp_map=&p_map->p_next)
+    {
+        if (p_map->p_io==p_io) {
+            if (!--p_map->refs) {
+                munmap((void*)p_map->p_io, p_map->len);
+                *pp_map = p_map->p_next;
+                free(p_map);
+            }
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&io_maps_mtx);
+}
 
 /* exported; see header for details */
 lr_errc_t sched_rt_raise_max(sched_rt_t *p_sched_h)
@@ -277,7 +410,7 @@ lr_errc_t sched_restore(sched_rt_t *p_sched_h)
 
     if (p_sched_h->sched >= 0) {
         param.sched_priority = p_sched_h->prio;
-        if (sched_setscheduler(0, p_sched_h->sched, &param)!=-1)
+        if (sched_setscheduler(0, p_sched_h->sched, &param)==-1)
         {
             err_printf("[%s] Can't restore original scheduler of the process; "
                 "sched_setscheduler() error: %d; %s\n",
@@ -291,3 +424,46 @@ lr_errc_t sched_restore(sched_rt_t *p_sched_h)
 
     return ret;
 }
+
+/* exported; see header for details */
+lr_errc_t thrd_create_rt(pthread_t *p_thrd,
+    void *(*routine)(void*), void *arg, bool_t *p_rt)
+{
+    int err;
+    pthread_attr_t attr;
+    struct sched_param param;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    /* try the real-time scheduler first */
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, RT_SCHED);
+    param.sched_priority = sched_get_priority_max(RT_SCHED);
+    pthread_attr_setschedparam(&attr, &param);
+
+    *p_rt = TRUE;
+    err = pthread_create(p_thrd, &attr, routine, arg);
+    pthread_attr_destroy(&attr);
+
+    if (err==EPERM) {
+        warn_printf("[%s] Can't set real-time scheduler for the thread\n",
+            __func__);
+        *p_rt = FALSE;
+        err = pthread_create(p_thrd, NULL, routine, arg);
+    }
+
+    if (err) {
+        err_printf("[%s] pthread_create() error: %d; %s\n",
+            __func__, err, strerror(err));
+        ret=LREC_SCHED_ERR;
+    }
+    return ret;
+}
+
+/* exported; see header for details */
+uint64_t time_ns(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
+}
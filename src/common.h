@@ -13,6 +13,7 @@
 #ifndef __COMMON_H__
 #define __COMMON_H__
 
+#include <pthread.h>
 #include <stdarg.h>
 #include "config.h"
 #include "librasp/common.h"
@@ -26,6 +27,13 @@ void err_printf(const char *format, ...);
 #define EXEC_RG(c) if ((ret=(c))!=LREC_SUCCESS) goto finish;
 #define EXEC_G(c) if ((c)!=LREC_SUCCESS) goto finish;
 
+/* GPIO number/mask arguments checks (GPIO_NUM, GPIO_MASK_ALL of gpio.h) */
+#define CHK_GPIO_NUM(n) \
+    if ((n)<0 || (n)>=GPIO_NUM) { ret=LREC_INV_ARG; goto finish; }
+
+#define CHK_GPIO_MASK(m) \
+    if ((m)&~GPIO_MASK_ALL) { ret=LREC_INV_ARG; goto finish; }
+
 /* for performance reason don't waste time for checking
    return code if it's guaranteed to be success */
 #if CONFIG_CLOCK_SYS_DRIVER
@@ -36,4 +44,36 @@ void err_printf(const char *format, ...);
 # define EXECLK_G(c)  (c)
 #endif
 
+/* atomic access to variables shared between threads */
+#define ATOMIC_LOAD(v)      __atomic_load_n(&(v), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(v, x)  __atomic_store_n(&(v), (x), __ATOMIC_RELEASE)
+
+/* real-time scheduler used for timing critical parts */
+#define RT_SCHED    SCHED_RR
+
+/* Create thread running 'routine' with the real-time scheduler of the maximum
+   priority. If not permitted the thread is created with the default scheduler
+   and FALSE is written under 'p_rt'.
+ */
+lr_errc_t thrd_create_rt(pthread_t *p_thrd,
+    void *(*routine)(void*), void *arg, bool_t *p_rt);
+
+/* CLOCK_MONOTONIC time [ns].
+ */
+uint64_t time_ns(void);
+
+#if CONFIG_SIM_DRIVER
+/* BCM's GPIO/STC simulator internals (see librasp/sim.h).
+
+   sim_attach() returns the simulated GPIO ('gpio' is TRUE) or STC registers
+   block; each attachment must be released by sim_detach(). sim_stc_update()
+   refreshes the STC registers only. sim_ack_events() clears GPEDSn latched
+   events specified by 'mask' (write-1-to-clear emulation).
+ */
+volatile void *sim_attach(bool_t gpio);
+void sim_detach(void);
+void sim_stc_update(void);
+void sim_ack_events(uint64_t mask);
+#endif
+
 #endif /* __COMMON_H__ */
@@ -26,6 +26,18 @@
 # define CONFIG_BCM_GPIO_EVENTS 0
 #endif
 
+/* GPIO character device (gpiochip) driver support. Requires kernel headers
+   providing GPIO uAPI v2 (Linux 5.10+). */
+#ifndef CONFIG_GPIO_CDEV_DRIVER
+# define CONFIG_GPIO_CDEV_DRIVER 1
+#endif
+
+/* In-process BCM's GPIO/STC simulator and its GPIO/clock SIM drivers
+   (see librasp/sim.h). */
+#ifndef CONFIG_SIM_DRIVER
+# define CONFIG_SIM_DRIVER 1
+#endif
+
 /* 1-wire write with pullup support; requires "wire" kernel module patch. */
 #ifndef CONFIG_WRITE_PULLUP
 # define CONFIG_WRITE_PULLUP 0
@@ -50,6 +62,20 @@
 # endif
 #endif
 
+#ifdef CONFIG_GPIO_CDEV_DRIVER
+# if (__EXT1(CONFIG_GPIO_CDEV_DRIVER) == 1)
+#  undef CONFIG_GPIO_CDEV_DRIVER
+#  define CONFIG_GPIO_CDEV_DRIVER 1
+# endif
+#endif
+
+#ifdef CONFIG_SIM_DRIVER
+# if (__EXT1(CONFIG_SIM_DRIVER) == 1)
+#  undef CONFIG_SIM_DRIVER
+#  define CONFIG_SIM_DRIVER 1
+# endif
+#endif
+
 #ifdef CONFIG_WRITE_PULLUP
 # if (__EXT1(CONFIG_WRITE_PULLUP) == 1)
 #  undef CONFIG_WRITE_PULLUP
@@ -0,0 +1,218 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "librasp/devices/qenc.h"
+
+/* illegal transition marker */
+#define QENC_ERR    2
+
+/* Transitions table indexed by (prev_ab<<2)|ab, where A is the higher bit.
+   Forward sequence: 00 -> 01 -> 11 -> 10 -> 00.
+ */
+static const int8_t qenc_trans[16] =
+{
+    /* 00 -> */ 0, 1, -1, QENC_ERR,
+    /* 01 -> */ -1, 0, QENC_ERR, 1,
+    /* 10 -> */ 1, QENC_ERR, 0, -1,
+    /* 11 -> */ QENC_ERR, -1, 1, 0
+};
+
+#define GET_AB(levs, p_enc) \
+    ((GPIO_LEV((levs), (p_enc)->a_gpio)<<1) | GPIO_LEV((levs), (p_enc)->b_gpio))
+
+/* exported; see header for details */
+lr_errc_t qenc_init(qenc_t *p_qenc,
+    gpio_hndl_t *p_gpio_h, uint32_t rate, uint32_t vel_win)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_qenc, 0, sizeof(*p_qenc));
+
+    if (!rate || rate>1000000000U) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+
+    p_qenc->p_gpio_h = p_gpio_h;
+    p_qenc->rate = rate;
+    p_qenc->vel_ticks = (uint32_t)MAX((uint64_t)rate*vel_win/1000U, 1);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void qenc_free(qenc_t *p_qenc)
+{
+    qenc_stop(p_qenc);
+}
+
+/* exported; see header for details */
+lr_errc_t qenc_add(qenc_t *p_qenc,
+    unsigned int a_gpio, unsigned int b_gpio, unsigned int *p_id)
+{
+    qenc_enc_t *p_enc;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (a_gpio>=GPIO_NUM || b_gpio>=GPIO_NUM || a_gpio==b_gpio) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (p_qenc->run) {
+        ret=LREC_NOT_SUPP;
+        goto finish;
+    }
+    if (p_qenc->n_encs>=QENC_MAX_ENCS) {
+        ret=LREC_NO_SPACE;
+        goto finish;
+    }
+
+    p_enc = &p_qenc->encs[p_qenc->n_encs];
+    memset(p_enc, 0, sizeof(*p_enc));
+    p_enc->a_gpio = a_gpio;
+    p_enc->b_gpio = b_gpio;
+    p_qenc->pins |= GPIO_MASK(a_gpio)|GPIO_MASK(b_gpio);
+
+    *p_id = p_qenc->n_encs++;
+finish:
+    return ret;
+}
+
+/* Decoder sampling thread.
+ */
+static void *qenc_thrd(void *arg)
+{
+    qenc_t *p_qenc = (qenc_t*)arg;
+
+    unsigned int i;
+    uint32_t period = 1000000000U/p_qenc->rate, vel_tick=0;
+    uint64_t levs, prev, next, now;
+    struct timespec tp;
+
+    if (gpio_read_bank(p_qenc->p_gpio_h, p_qenc->pins, &prev)!=LREC_SUCCESS)
+        prev = 0;
+    for (i=0; i<p_qenc->n_encs; i++)
+        p_qenc->encs[i].ab = GET_AB(prev, &p_qenc->encs[i]);
+
+    next = time_ns();
+
+    while (ATOMIC_LOAD(p_qenc->run))
+    {
+        next += period;
+        tp.tv_sec = next/1000000000U;
+        tp.tv_nsec = next%1000000000U;
+        /* restart the sleep interrupted by a signal */
+        while (clock_nanosleep(
+            CLOCK_MONOTONIC, TIMER_ABSTIME, &tp, NULL)==EINTR);
+
+        /* missed ticks (e.g. due to preemption) may result in lost counts */
+        now = time_ns();
+        if ((int64_t)(now-next) >= (int64_t)period) {
+            uint64_t n_miss = (now-next)/period;
+            ATOMIC_STORE(p_qenc->n_overruns, p_qenc->n_overruns+n_miss);
+            next += n_miss*period;
+        }
+        ATOMIC_STORE(p_qenc->n_ticks, p_qenc->n_ticks+1);
+
+        if (gpio_read_bank(p_qenc->p_gpio_h, p_qenc->pins, &levs)==LREC_SUCCESS &&
+            levs!=prev)
+        {
+            for (i=0; i<p_qenc->n_encs; i++)
+            {
+                qenc_enc_t *p_enc = &p_qenc->encs[i];
+                unsigned int ab = GET_AB(levs, p_enc);
+                int8_t d;
+
+                if (ab==p_enc->ab) continue;
+
+                d = qenc_trans[(p_enc->ab<<2)|ab];
+                if (d==QENC_ERR) {
+                    ATOMIC_STORE(p_enc->n_errs, p_enc->n_errs+1);
+                } else {
+                    ATOMIC_STORE(p_enc->count, p_enc->count+d);
+                }
+                p_enc->ab = ab;
+            }
+            prev = levs;
+        }
+
+        if (++vel_tick>=p_qenc->vel_ticks)
+        {
+            for (i=0; i<p_qenc->n_encs; i++) {
+                qenc_enc_t *p_enc = &p_qenc->encs[i];
+                ATOMIC_STORE(p_enc->vel, (int32_t)((p_enc->count-p_enc->vel_count)*
+                    (int64_t)p_qenc->rate/(int64_t)p_qenc->vel_ticks));
+                p_enc->vel_count = p_enc->count;
+            }
+            vel_tick = 0;
+        }
+    }
+    return NULL;
+}
+
+/* exported; see header for details */
+lr_errc_t qenc_start(qenc_t *p_qenc)
+{
+    unsigned int i;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_qenc->run) goto finish;
+
+    for (i=0; i<p_qenc->n_encs; i++) {
+        p_qenc->encs[i].count = p_qenc->encs[i].vel_count = 0;
+        p_qenc->encs[i].vel = 0;
+        p_qenc->encs[i].n_errs = 0;
+    }
+    p_qenc->n_ticks = p_qenc->n_overruns = 0;
+    ATOMIC_STORE(p_qenc->run, TRUE);
+
+    if ((ret=thrd_create_rt(
+        &p_qenc->thrd, qenc_thrd, p_qenc, &p_qenc->rt))!=LREC_SUCCESS)
+    {
+        ATOMIC_STORE(p_qenc->run, FALSE);
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void qenc_stop(qenc_t *p_qenc)
+{
+    if (p_qenc->run) {
+        ATOMIC_STORE(p_qenc->run, FALSE);
+        pthread_join(p_qenc->thrd, NULL);
+    }
+}
+
+/* exported; see header for details */
+lr_errc_t qenc_read(qenc_t *p_qenc, unsigned int id,
+    int64_t *p_count, int32_t *p_vel, uint64_t *p_n_errs)
+{
+    qenc_enc_t *p_enc;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (id>=p_qenc->n_encs) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    p_enc = &p_qenc->encs[id];
+
+    if (p_count) *p_count = ATOMIC_LOAD(p_enc->count);
+    if (p_vel) *p_vel = ATOMIC_LOAD(p_enc->vel);
+    if (p_n_errs) *p_n_errs = ATOMIC_LOAD(p_enc->n_errs);
+finish:
+    return ret;
+}
@@ -15,200 +15,1325 @@
 #include <poll.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 
 #include "common.h"
 #include "librasp/gpio.h"
+#include "librasp/sim.h"
+
+#if CONFIG_GPIO_CDEV_DRIVER
+# include <sys/ioctl.h>
+# include <linux/gpio.h>
+#endif
 
 #define	BCM_GPIO_MAP_LEN    PAGE_SZ
 
-/* exported; see header for details */
-lr_errc_t gpio_init(gpio_hndl_t *p_hndl, gpio_driver_t drv)
+/* handle with no active driver (not initialized or freed) */
+#define CHK_DRV(h) \
+    if (!(h)->p_ops) { ret=LREC_NOINIT; goto finish; }
+
+/* synchronize simulator after registers write or before read */
+#if CONFIG_SIM_DRIVER
+# define SIM_SYNC(h) if ((h)->io.sim) sim_sync();
+#else
+# define SIM_SYNC(h)
+#endif
+
+/* Number of GPFSELn registers */
+#define GPFSEL_NUM  ((GPIO_NUM+9)/10)
+
+/* Locks serializing read-modify-write sequences of the BCM's GPIO registers:
+   GPFSELn (per register), event detect enables (per bank) and the pulls
+   configuration (GPPUD clocking sequence or GPIO_PUP_PDN_CNTRL_REGn). The I/O
+   mapping is shared by all the handles of the process, so are the locks.
+   GPSETn, GPCLRn, GPLEVn accesses are not read-modify-write and lock-free.
+ */
+static pthread_mutex_t fsel_locks[GPFSEL_NUM] =
+    { [0 ... GPFSEL_NUM-1] = PTHREAD_MUTEX_INITIALIZER };
+#if CONFIG_BCM_GPIO_EVENTS
+static pthread_mutex_t evt_locks[2] =
+    { [0 ... 1] = PTHREAD_MUTEX_INITIALIZER };
+#endif
+static pthread_mutex_t pull_lock = PTHREAD_MUTEX_INITIALIZER;
+
+#if CONFIG_GPIO_CDEV_DRIVER
+
+#define CDEV_CONSUMER   "librasp"
+
+#define CDEV_EDGE_FLAGS \
+    ((uint64_t)(GPIO_V2_LINE_FLAG_EDGE_RISING|GPIO_V2_LINE_FLAG_EDGE_FALLING))
+#define CDEV_BIAS_FLAGS \
+    ((uint64_t)(GPIO_V2_LINE_FLAG_BIAS_PULL_UP| \
+    GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN|GPIO_V2_LINE_FLAG_BIAS_DISABLED))
+#define CDEV_DRIVE_FLAGS \
+    ((uint64_t)(GPIO_V2_LINE_FLAG_OPEN_DRAIN|GPIO_V2_LINE_FLAG_OPEN_SOURCE))
+#define CDEV_DIR_FLAGS \
+    ((uint64_t)(GPIO_V2_LINE_FLAG_INPUT|GPIO_V2_LINE_FLAG_OUTPUT))
+
+/* Convert GPIOs mask into a bitmap of the lines indexes as used by the lines
+   request containing 'lines'.
+ */
+#define cdev_mask2bits(lines, mask) gpio_bank_extract((mask), (lines))
+
+/* Convert bitmap of the lines indexes of the lines request containing 'lines'
+   into GPIOs mask (reverse to cdev_mask2bits()).
+ */
+static uint64_t cdev_bits2mask(uint64_t lines, uint64_t bits)
+{
+    uint64_t ret=0;
+
+    for (; lines && bits; lines&=lines-1, bits>>=1) {
+        if (bits&1) ret |= lines & -lines;
+    }
+    return ret;
+}
+
+/* Open GPIO chip if not yet done.
+ */
+static lr_errc_t cdev_open_chip(gpio_hndl_t *p_hndl)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_hndl->cdev.chipfd == -1 &&
+        (p_hndl->cdev.chipfd = open(p_hndl->cdev.chip, O_RDWR|O_CLOEXEC)) == -1)
+    {
+        err_printf("[%s] GPIO chip %s open error: %d; %s\n",
+            __func__, p_hndl->cdev.chip, errno, strerror(errno));
+        ret=LREC_OPEN_ERR;
+    }
+    return ret;
+}
+
+/* Release requested lines and close GPIO chip.
+ */
+static void cdev_close_chip(gpio_hndl_t *p_hndl)
+{
+    if (p_hndl->cdev.reqfd != -1) {
+        close(p_hndl->cdev.reqfd);
+        p_hndl->cdev.reqfd = -1;
+    }
+    if (p_hndl->cdev.chipfd != -1) {
+        close(p_hndl->cdev.chipfd);
+        p_hndl->cdev.chipfd = -1;
+    }
+    p_hndl->cdev.lines = 0;
+}
+
+/* Get effective line flags. The kernel rejects edge detection for output
+   lines and drive configuration for input ones.
+ */
+static uint64_t cdev_eff_flags(uint64_t flags)
+{
+    if (flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+        flags &= ~CDEV_EDGE_FLAGS;
+    } else {
+        flags &= ~CDEV_DRIVE_FLAGS;
+    }
+    return flags;
+}
+
+/* Build configuration for the lines request containing 'lines'. Flags of the
+   first line constitute the default configuration, lines with different flags
+   are grouped into the configuration attributes.
+ */
+static lr_errc_t cdev_line_config(
+    gpio_hndl_t *p_hndl, uint64_t lines, struct gpio_v2_line_config *p_cfg)
+{
+    unsigned int gpio, i;
+    uint64_t bit, outs=0, outvals=0;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_cfg, 0, sizeof(*p_cfg));
+
+    for (gpio=0, bit=1; (lines>>gpio); gpio++)
+    {
+        uint64_t flags;
+
+        if (!((lines>>gpio)&1)) continue;
+
+        flags = cdev_eff_flags(p_hndl->cdev.flags[gpio]);
+        if (bit==1) {
+            p_cfg->flags = flags;
+        } else
+        if (flags!=p_cfg->flags)
+        {
+            for (i=0; i<p_cfg->num_attrs; i++) {
+                if (p_cfg->attrs[i].attr.flags==flags) break;
+            }
+            if (i>=p_cfg->num_attrs) {
+                /* the last attribute is reserved for the output values */
+                if (i>=GPIO_V2_LINE_NUM_ATTRS_MAX-1) {
+                    err_printf("[%s] Too many lines configurations\n",
+                        __func__);
+                    ret=LREC_NO_SPACE;
+                    goto finish;
+                }
+                p_cfg->attrs[i].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+                p_cfg->attrs[i].attr.flags = flags;
+                p_cfg->num_attrs++;
+            }
+            p_cfg->attrs[i].mask |= bit;
+        }
+
+        if (flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+            outs |= bit;
+            if ((p_hndl->cdev.outvals>>gpio)&1) outvals |= bit;
+        }
+        bit <<= 1;
+    }
+
+    if (outs) {
+        i = p_cfg->num_attrs++;
+        p_cfg->attrs[i].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        p_cfg->attrs[i].attr.values = outvals;
+        p_cfg->attrs[i].mask = outs;
+    }
+finish:
+    return ret;
+}
+
+/* (Re)request 'lines' with their current configuration. Previously requested
+   lines are released.
+ */
+static lr_errc_t cdev_request_lines(gpio_hndl_t *p_hndl, uint64_t lines)
+{
+    unsigned int gpio;
+    struct gpio_v2_line_request req;
+    uint64_t prev_lines = p_hndl->cdev.lines;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    EXEC_RG(cdev_open_chip(p_hndl));
+
+    memset(&req, 0, sizeof(req));
+    for (gpio=0; (lines>>gpio); gpio++) {
+        if ((lines>>gpio)&1) req.offsets[req.num_lines++] = gpio;
+    }
+    strncpy(req.consumer, CDEV_CONSUMER, sizeof(req.consumer)-1);
+    req.event_buffer_size = p_hndl->cdev.ev_bufsz;
+    EXEC_RG(cdev_line_config(p_hndl, lines, &req.config));
+
+    if (p_hndl->cdev.reqfd != -1) {
+        close(p_hndl->cdev.reqfd);
+        p_hndl->cdev.reqfd = -1;
+        p_hndl->cdev.lines = 0;
+    }
+
+    if (lines) {
+        if (ioctl(p_hndl->cdev.chipfd, GPIO_V2_GET_LINE_IOCTL, &req) == -1) {
+            err_printf("[%s] GPIO lines request error: %d; %s\n",
+                __func__, errno, strerror(errno));
+            ret=LREC_IOCTL_ERR;
+
+            /* try to restore the previous request */
+            if (prev_lines && prev_lines!=lines)
+                cdev_request_lines(p_hndl, prev_lines);
+            goto finish;
+        }
+        p_hndl->cdev.reqfd = req.fd;
+        p_hndl->cdev.req_id++;
+        p_hndl->cdev.lines = lines;
+
+        /* events are read in the non-blocking mode */
+        fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL)|O_NONBLOCK);
+    }
+finish:
+    return ret;
+}
+
+/* Apply the current configuration of the requested lines.
+ */
+static lr_errc_t cdev_set_config(gpio_hndl_t *p_hndl)
+{
+    struct gpio_v2_line_config cfg;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    EXEC_RG(cdev_line_config(p_hndl, p_hndl->cdev.lines, &cfg));
+
+    if (ioctl(p_hndl->cdev.reqfd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &cfg) == -1) {
+        err_printf("[%s] GPIO lines config error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_IOCTL_ERR;
+    }
+finish:
+    return ret;
+}
+
+#define CHK_CDEV_LINES(m) \
+    if ((m)&~p_hndl->cdev.lines) { ret=LREC_NOINIT; goto finish; }
+
+/* Set direction (and value for output) of a requested line.
+ */
+static lr_errc_t cdev_set_direction(gpio_hndl_t *p_hndl,
+    unsigned int gpio, bool_t as_out, unsigned int val)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+    CHK_CDEV_LINES(GPIO_MASK(gpio));
+
+    p_hndl->cdev.flags[gpio] = SET_BITFLD(p_hndl->cdev.flags[gpio],
+        (as_out ? GPIO_V2_LINE_FLAG_OUTPUT : GPIO_V2_LINE_FLAG_INPUT),
+        CDEV_DIR_FLAGS);
+    if (as_out) {
+        p_hndl->cdev.outvals = SET_BITFLD(p_hndl->cdev.outvals,
+            (val ? GPIO_MASK(gpio) : 0), GPIO_MASK(gpio));
+    }
+    ret = cdev_set_config(p_hndl);
+finish:
+    return ret;
+}
+
+/* Get values of requested lines specified by 'mask'.
+ */
+static lr_errc_t
+    cdev_get_values(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_levs)
+{
+    struct gpio_v2_line_values lv;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_CDEV_LINES(mask);
+
+    if (!mask) {
+        *p_levs = 0;
+        goto finish;
+    }
+    if (p_hndl->cdev.reqfd==-1) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    lv.bits = 0;
+    lv.mask = cdev_mask2bits(p_hndl->cdev.lines, mask);
+    if (ioctl(p_hndl->cdev.reqfd, GPIO_V2_LINE_GET_VALUES_IOCTL, &lv) == -1) {
+        err_printf("[%s] GPIO lines get values error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_IOCTL_ERR;
+        goto finish;
+    }
+    *p_levs = cdev_bits2mask(p_hndl->cdev.lines, lv.bits&lv.mask);
+finish:
+    return ret;
+}
+
+/* Set values of requested lines specified by 'mask'.
+ */
+static lr_errc_t
+    cdev_set_values(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val)
+{
+    struct gpio_v2_line_values lv;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_CDEV_LINES(mask);
+
+    if (!mask) goto finish;
+    if (p_hndl->cdev.reqfd==-1) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    lv.mask = cdev_mask2bits(p_hndl->cdev.lines, mask);
+    lv.bits = cdev_mask2bits(p_hndl->cdev.lines, mask&val);
+    if (ioctl(p_hndl->cdev.reqfd, GPIO_V2_LINE_SET_VALUES_IOCTL, &lv) == -1) {
+        err_printf("[%s] GPIO lines set values error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_IOCTL_ERR;
+        goto finish;
+    }
+    p_hndl->cdev.outvals = SET_BITFLD(p_hndl->cdev.outvals, mask&val, mask);
+finish:
+    return ret;
+}
+
+/* Set edge detection of a requested line.
+ */
+static lr_errc_t
+    cdev_set_event(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event)
+{
+    uint64_t edge=0;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+    CHK_CDEV_LINES(GPIO_MASK(gpio));
+
+    if (event!=GPIO_EVENT_NONE) {
+        if (!(event&GPIO_EVENT_BOTH)) {
+            ret=LREC_INV_ARG;
+            goto finish;
+        }
+        if (event&GPIO_EVENT_RAISING) edge|=GPIO_V2_LINE_FLAG_EDGE_RISING;
+        if (event&GPIO_EVENT_FALLING) edge|=GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    }
+
+    p_hndl->cdev.flags[gpio] =
+        SET_BITFLD(p_hndl->cdev.flags[gpio], edge, CDEV_EDGE_FLAGS);
+    ret = cdev_set_config(p_hndl);
+finish:
+    return ret;
+}
+
+/* Perform up to 'n_ops' GPIO chip line info queries (CDEV driver probing
+   operation); return number of the succeeded ones.
+ */
+static unsigned int cdev_probe_ops(gpio_hndl_t *p_hndl, unsigned int n_ops)
+{
+    unsigned int i;
+    struct gpio_v2_line_info info;
+
+    for (i=0; i<n_ops; i++) {
+        memset(&info, 0, sizeof(info));
+        if (ioctl(p_hndl->cdev.chipfd, GPIO_V2_GET_LINEINFO_IOCTL, &info))
+            break;
+    }
+    return i;
+}
+
+#else
+# define cdev_open_chip(h) LREC_NOT_SUPP
+# define cdev_close_chip(h)
+# define cdev_probe_ops(h, n) 0U
+#endif /* CONFIG_GPIO_CDEV_DRIVER */
+
+/* Open GPIO sysfs attribute.
+ */
+static int sysfs_open_attr(unsigned int gpio, const char *attr, int flags)
+{
+    char buf[40];
+
+    sprintf(buf, "/sys/class/gpio/gpio%d/%s", gpio, attr);
+    return open(buf, flags);
+}
+
+/* Open GPIO sysfs attribute under 'p_fd' handle if not yet done.
+ */
+static lr_errc_t sysfs_open(unsigned int gpio, const char *attr,
+    int flags, int *p_fd)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (*p_fd == -1 && (*p_fd = sysfs_open_attr(gpio, attr, flags)) == -1)
+    {
+        err_printf("[%s] sysfs gpio-%s open error: %d; %s\n"
+            "Haven't forget to export the gpio?\n",
+            __func__, attr, errno, strerror(errno));
+        ret=LREC_OPEN_ERR;
+    }
+    return ret;
+}
+
+/* Close GPIO sysfs handles and invalidate its cached settings.
+ */
+static void sysfs_close(gpio_hndl_t *p_hndl, unsigned int gpio)
+{
+    if (p_hndl->sysfs.valfds[gpio] != -1) close(p_hndl->sysfs.valfds[gpio]);
+    if (p_hndl->sysfs.dirfds[gpio] != -1) close(p_hndl->sysfs.dirfds[gpio]);
+    if (p_hndl->sysfs.edgefds[gpio] != -1) close(p_hndl->sysfs.edgefds[gpio]);
+
+    p_hndl->sysfs.valfds[gpio] = -1;
+    p_hndl->sysfs.dirfds[gpio] = -1;
+    p_hndl->sysfs.edgefds[gpio] = -1;
+    p_hndl->sysfs.dirs[gpio] = -1;
+    p_hndl->sysfs.edges[gpio] = -1;
+}
+
+/* drivers operations access (defined below) */
+static const gpio_drv_ops_t *get_drv_ops(gpio_driver_t drv);
+
+/* Number of timed operations per probed driver */
+#define PROBE_IO_OPS    1000U
+#define PROBE_SYS_OPS   100U
+
+/* built-in drivers probing results */
+static pthread_once_t drv_probe_once = PTHREAD_ONCE_INIT;
+static gpio_drv_probe_t drv_probe;
+
+/* Probe a built-in driver; return its per-operation cost [ns] or 0 if the
+   driver is not available.
+ */
+static uint32_t probe_drv(gpio_driver_t drv)
+{
+    gpio_hndl_t hndl;
+    uint64_t start, levs;
+    uint32_t cost=0;
+    unsigned int n=0;
+
+    /* quiet access path checks (no errors logged) */
+    switch (drv)
+    {
+    case gpio_drv_io:
+    case gpio_drv_gpio:
+        if (!get_bcm_io_base() ||
+            access((drv==gpio_drv_io ? DEV_MEM_IO : DEV_MEM_GPIO), R_OK|W_OK))
+            goto finish;
+        break;
+    case gpio_drv_cdev:
+        if (!CONFIG_GPIO_CDEV_DRIVER || access(DEV_GPIOCHIP, R_OK|W_OK))
+            goto finish;
+        break;
+    default:
+        goto finish;
+    }
+
+    if (gpio_init(&hndl, drv)==LREC_SUCCESS)
+    {
+        start = time_ns();
+        switch (drv)
+        {
+        case gpio_drv_io:
+        case gpio_drv_gpio:
+            for (; n<PROBE_IO_OPS; n++) {
+                if (gpio_read_bank(&hndl, GPIO_MASK_ALL, &levs)!=LREC_SUCCESS)
+                    break;
+            }
+            break;
+        default:
+            n = cdev_probe_ops(&hndl, PROBE_SYS_OPS);
+            break;
+        }
+        if (n) {
+            cost = (uint32_t)((time_ns()-start)/n);
+            if (!cost) cost=1;
+        }
+    }
+    gpio_free(&hndl);
+finish:
+    return cost;
+}
+
+/* Probe the built-in drivers and select the fastest one.
+ */
+static void probe_drvs(void)
+{
+    static const gpio_driver_t cands[] =
+        { gpio_drv_io, gpio_drv_gpio, gpio_drv_cdev };
+    unsigned int i;
+    uint32_t cost, best=0;
+
+    memset(&drv_probe, 0, sizeof(drv_probe));
+    drv_probe.drv = (gpio_driver_t)-1;
+
+    for (i=0; i<ARRAY_SZ(cands); i++)
+    {
+        cost = drv_probe.costs[cands[i]] = probe_drv(cands[i]);
+
+        /* the later probed driver must be at least 10% faster */
+        if (cost && (!best || (uint64_t)cost*10 < (uint64_t)best*9)) {
+            drv_probe.drv = cands[i];
+            best = cost;
+        }
+    }
+
+    /* SYSFS has no non-intrusive GPIO access (a GPIO must be exported to
+       read its value), therefore it's not cost probed but is a fallback */
+    if (drv_probe.drv==(gpio_driver_t)-1 &&
+        !access("/sys/class/gpio/export", W_OK))
+    {
+        drv_probe.drv = gpio_drv_sysfs;
+    }
+}
+
+/* exported; see header for details */
+void gpio_get_drv_probe(gpio_drv_probe_t *p_probe)
+{
+    pthread_once(&drv_probe_once, probe_drvs);
+    *p_probe = drv_probe;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_prepare(gpio_hndl_t *p_hndl, uint64_t mask, int timeout)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(mask);
+
+    if (p_hndl->drv==gpio_drv_cdev) {
+        ret = gpio_cdev_request(p_hndl, mask);
+    } else
+    if (p_hndl->drv==gpio_drv_sysfs) {
+        ret = gpio_sysfs_export_many(p_hndl, mask, timeout);
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_unprepare(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    unsigned int gpio;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(mask);
+
+    if (p_hndl->drv==gpio_drv_cdev) {
+        ret = gpio_cdev_release(p_hndl, mask);
+    } else
+    if (p_hndl->drv==gpio_drv_sysfs) {
+        for (gpio=0; (mask>>gpio); gpio++) {
+            if ((mask>>gpio)&1) EXEC_RG(gpio_sysfs_unexport(p_hndl, gpio));
+        }
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_init(gpio_hndl_t *p_hndl, gpio_driver_t drv)
+{
+    int i;
+
+    p_hndl->drv = (gpio_driver_t)-1;
+    p_hndl->p_ops = NULL;
+    p_hndl->drv_data = NULL;
+    p_hndl->io.p_gpio_io = NULL;
+    p_hndl->io.plat = (platform_t)-1;
+    p_hndl->io.sim = FALSE;
+    for (i=0 ; i<ARRAY_SZ(p_hndl->sysfs.valfds); i++) {
+        p_hndl->sysfs.valfds[i]=-1;
+        p_hndl->sysfs.dirfds[i]=-1;
+        p_hndl->sysfs.edgefds[i]=-1;
+        p_hndl->sysfs.dirs[i]=-1;
+        p_hndl->sysfs.edges[i]=-1;
+    }
+
+    strcpy(p_hndl->cdev.chip, DEV_GPIOCHIP);
+    p_hndl->cdev.chipfd = -1;
+    p_hndl->cdev.reqfd = -1;
+    p_hndl->cdev.req_id = 0;
+    p_hndl->cdev.lines = 0;
+    p_hndl->cdev.outvals = 0;
+    memset(p_hndl->cdev.flags, 0, sizeof(p_hndl->cdev.flags));
+    p_hndl->cdev.ev_bufsz = 0;
+
+    return gpio_set_driver(p_hndl, drv);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_set_driver(gpio_hndl_t *p_hndl, gpio_driver_t drv)
+{
+    const gpio_drv_ops_t *p_ops=NULL;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (drv==gpio_drv_auto)
+    {
+        /* activate the fastest probed driver */
+        pthread_once(&drv_probe_once, probe_drvs);
+
+        if (drv_probe.drv!=(gpio_driver_t)-1) {
+            ret = gpio_set_driver(p_hndl, drv_probe.drv);
+        } else {
+            err_printf("[%s] No GPIO driver available\n", __func__);
+            ret=LREC_NOT_SUPP;
+        }
+        return ret;
+    }
+
+    if (drv>=gpio_drv_custom && drv<GPIO_DRV_MAX)
+    {
+        /* registered driver */
+        p_ops = get_drv_ops(drv);
+
+        if (!p_ops) {
+            ret=LREC_INV_ARG;
+        } else
+        if (drv!=p_hndl->drv && p_ops->init) {
+            ret = p_ops->init(p_hndl);
+        }
+    } else
+    switch (drv)
+    {
+    default:
+        drv = gpio_drv_io;
+        /* fall-through */
+
+    case gpio_drv_io:
+    case gpio_drv_gpio:
+      {
+        if (p_hndl->io.sim) {
+            /* I/O attached to the simulator */
+            ret=LREC_NOT_SUPP;
+        } else
+        if (!p_hndl->io.p_gpio_io)
+        {
+            uint32_t io_base = get_bcm_io_base();
+            if (io_base) {
+                if (!(p_hndl->io.p_gpio_io = io_mmap_shared(
+                    (drv == gpio_drv_io ? DEV_MEM_IO : DEV_MEM_GPIO),
+                    io_base+GPIO_BASE_RA, BCM_GPIO_MAP_LEN)))
+                {
+                    ret=LREC_MMAP_ERR;
+                } else {
+                    p_hndl->io.plat = platform_detect();
+                }
+            } else {
+                err_printf("[%s] BCM platform not detected\n", __func__);
+                ret=LREC_PLAT_ERR;
+            }
+        } else {
+            /* already initialized I/O */
+        }
+        break;
+      }
+
+    case gpio_drv_sysfs:
+        /* no initialization needed in this case */
+        break;
+
+    case gpio_drv_cdev:
+        ret = cdev_open_chip(p_hndl);
+        break;
+
+    case gpio_drv_sim:
+#if CONFIG_SIM_DRIVER
+        if (!p_hndl->io.p_gpio_io) {
+            p_hndl->io.p_gpio_io = sim_attach(TRUE);
+            /* simulated pulls are controlled as for BCM2711 */
+            p_hndl->io.plat = bcm_2711;
+            p_hndl->io.sim = TRUE;
+        } else
+        if (!p_hndl->io.sim) {
+            /* I/O mapped to the real GPIO */
+            ret=LREC_NOT_SUPP;
+        }
+#else
+        ret=LREC_NOT_SUPP;
+#endif
+        break;
+    }
+
+    if (ret==LREC_SUCCESS)
+    {
+        /* release the previously active registered driver */
+        if (p_hndl->drv!=drv && p_hndl->drv>=gpio_drv_custom &&
+            p_hndl->drv<GPIO_DRV_MAX && p_hndl->p_ops->free)
+        {
+            p_hndl->p_ops->free(p_hndl);
+        }
+
+        p_hndl->drv = drv;
+        p_hndl->p_ops = (p_ops ? p_ops : get_drv_ops(drv));
+    }
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_free(gpio_hndl_t *p_hndl)
+{
+    int i;
+
+    if (p_hndl->drv!=(gpio_driver_t)-1)
+    {
+        /* free registered driver resources */
+        if (p_hndl->drv>=gpio_drv_custom && p_hndl->drv<GPIO_DRV_MAX &&
+            p_hndl->p_ops->free)
+        {
+            p_hndl->p_ops->free(p_hndl);
+        }
+
+        /* free I/O driver resources */
+        if (p_hndl->io.p_gpio_io) {
+#if CONFIG_SIM_DRIVER
+            if (p_hndl->io.sim) {
+                sim_detach();
+                p_hndl->io.sim = FALSE;
+            } else
+#endif
+            io_munmap_shared(p_hndl->io.p_gpio_io);
+            p_hndl->io.p_gpio_io = NULL;
+        }
+
+        /* free SYSFS driver resources */
+        for (i=0 ; i<ARRAY_SZ(p_hndl->sysfs.valfds); i++)
+            sysfs_close(p_hndl, i);
+
+        /* free CDEV driver resources */
+        cdev_close_chip(p_hndl);
+
+        /* mark the handle as closed */
+        p_hndl->drv = (gpio_driver_t)-1;
+        p_hndl->p_ops = NULL;
+    }
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_bcm_get_func(
+    gpio_hndl_t *p_hndl, unsigned int gpio, gpio_bcm_func_t *p_func)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    if (p_hndl->io.p_gpio_io) {
+        volatile uint32_t *p_gpfsel = IO_REG32_PTR(
+            p_hndl->io.p_gpio_io, GPFSEL0+sizeof(uint32_t)*(gpio/10));
+        *p_func = (gpio_bcm_func_t)((*p_gpfsel>>(3*(gpio%10)))&7);
+    } else
+        ret=LREC_NOINIT;
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_bcm_set_func(
+    gpio_hndl_t *p_hndl, unsigned int gpio, gpio_bcm_func_t func)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    if (p_hndl->io.p_gpio_io) {
+        unsigned int shl = 3*(gpio%10);
+        volatile uint32_t *p_gpfsel = IO_REG32_PTR(
+            p_hndl->io.p_gpio_io, GPFSEL0+sizeof(uint32_t)*(gpio/10));
+
+        pthread_mutex_lock(&fsel_locks[gpio/10]);
+        *p_gpfsel = (volatile uint32_t)SET_BITFLD(
+            *p_gpfsel, ((uint32_t)func&7)<<shl, (uint32_t)7<<shl);
+        pthread_mutex_unlock(&fsel_locks[gpio/10]);
+        SIM_SYNC(p_hndl);
+    } else
+        ret=LREC_NOINIT;
+
+finish:
+    return ret;
+}
+
+/* Write GPFSELn registers with fields specified by 'p_msk' masks set to the
+   corresponding 'p_sel' values. Each register with non-zero mask is read and
+   written once.
+ */
+static void io_set_funcs(
+    gpio_hndl_t *p_hndl, const uint32_t *p_sel, const uint32_t *p_msk)
+{
+    unsigned int i;
+
+    for (i=0; i<GPFSEL_NUM; i++)
+    {
+        volatile uint32_t *p_gpfsel;
+
+        if (!p_msk[i]) continue;
+
+        p_gpfsel = IO_REG32_PTR(
+            p_hndl->io.p_gpio_io, GPFSEL0+sizeof(uint32_t)*i);
+
+        pthread_mutex_lock(&fsel_locks[i]);
+        *p_gpfsel = (volatile uint32_t)SET_BITFLD(*p_gpfsel, p_sel[i], p_msk[i]);
+        pthread_mutex_unlock(&fsel_locks[i]);
+    }
+    SIM_SYNC(p_hndl);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_bcm_set_func_many(gpio_hndl_t *p_hndl,
+    const gpio_bcm_func_cfg_t *p_cfg, size_t n_cfg)
+{
+    size_t i;
+    uint32_t sel[GPFSEL_NUM], msk[GPFSEL_NUM];
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!p_hndl->io.p_gpio_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    memset(sel, 0, sizeof(sel));
+    memset(msk, 0, sizeof(msk));
+
+    for (i=0; i<n_cfg; i++)
+    {
+        unsigned int gpio = p_cfg[i].gpio, shl;
+
+        CHK_GPIO_NUM(gpio);
+
+        shl = 3*(gpio%10);
+        sel[gpio/10] = SET_BITFLD(sel[gpio/10],
+            ((uint32_t)p_cfg[i].func&7)<<shl, (uint32_t)7<<shl);
+        msk[gpio/10] |= (uint32_t)7<<shl;
+    }
+    io_set_funcs(p_hndl, sel, msk);
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_bcm_set_func_mask(
+    gpio_hndl_t *p_hndl, uint64_t mask, gpio_bcm_func_t func)
+{
+    unsigned int gpio, shl;
+    uint32_t sel[GPFSEL_NUM], msk[GPFSEL_NUM];
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(mask);
+
+    if (!p_hndl->io.p_gpio_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    memset(sel, 0, sizeof(sel));
+    memset(msk, 0, sizeof(msk));
+
+    for (gpio=0; (mask>>gpio); gpio++) {
+        if ((mask>>gpio)&1) {
+            shl = 3*(gpio%10);
+            sel[gpio/10] |= ((uint32_t)func&7)<<shl;
+            msk[gpio/10] |= (uint32_t)7<<shl;
+        }
+    }
+    io_set_funcs(p_hndl, sel, msk);
+
+finish:
+    return ret;
+}
+
+/* Set GPIO direction on sysfs. If GPIO value sysfs handle is not yet obtained -
+   do it. The direction is not written if already set by the handle.
+ */
+static lr_errc_t
+    sysfs_set_direction(gpio_hndl_t *p_hndl, unsigned int gpio, bool_t as_out)
+{
+    const char *dir_str;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    EXEC_RG(sysfs_open(gpio, "value", O_RDWR, &p_hndl->sysfs.valfds[gpio]));
+    if (p_hndl->sysfs.dirs[gpio] == (as_out!=FALSE)) goto finish;
+
+    EXEC_RG(sysfs_open(
+        gpio, "direction", O_WRONLY, &p_hndl->sysfs.dirfds[gpio]));
+
+    dir_str = (as_out ? "out" : "in");
+    if (pwrite(p_hndl->sysfs.dirfds[gpio],
+        dir_str, strlen(dir_str), 0) == -1)
+    {
+        err_printf("[%s] sysfs gpio-direction write error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        p_hndl->sysfs.dirs[gpio] = -1;
+        ret=LREC_WRITE_ERR;
+    } else
+        p_hndl->sysfs.dirs[gpio] = (as_out!=FALSE);
+
+finish:
+    return ret;
+}
+
+/* Set GPIO event on sysfs. The edge is not written if already set by the
+   handle.
+ */
+static lr_errc_t
+    sysfs_set_event(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event)
+{
+    const char *ev_str;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    if (event==GPIO_EVENT_NONE) {
+        ev_str = "none";
+    } else
+    if ((event&GPIO_EVENT_RAISING)!=0 && (event&GPIO_EVENT_FALLING)!=0) {
+        ev_str = "both";
+    } else
+    if ((event&GPIO_EVENT_RAISING)!=0) {
+        ev_str = "rising";
+    } else
+    if ((event&GPIO_EVENT_FALLING)!=0) {
+        ev_str = "falling";
+    } else {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    event &= GPIO_EVENT_BOTH;
+
+    if (p_hndl->sysfs.edges[gpio] == (int8_t)event) goto finish;
+
+    EXEC_RG(sysfs_open(gpio, "edge", O_WRONLY, &p_hndl->sysfs.edgefds[gpio]));
+
+    if (pwrite(p_hndl->sysfs.edgefds[gpio], ev_str, strlen(ev_str), 0) == -1)
+    {
+        err_printf("[%s] sysfs gpio-edge write error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        p_hndl->sysfs.edges[gpio] = -1;
+        ret=LREC_WRITE_ERR;
+    } else
+        p_hndl->sysfs.edges[gpio] = (int8_t)event;
+
+finish:
+    return ret;
+}
+
+/* I/O driver.
+ */
+static lr_errc_t io_direction_input(gpio_hndl_t *p_hndl, unsigned int gpio)
+{
+    return gpio_bcm_set_func(p_hndl, gpio, gpio_bcm_in);
+}
+
+static lr_errc_t
+    io_direction_output(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
+{
+    /* set value at first to avoid output blink */
+    gpio_io_set_fast(p_hndl, gpio, val);
+    return gpio_bcm_set_func(p_hndl, gpio, gpio_bcm_out);
+}
+
+static lr_errc_t
+    io_get_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_val)
+{
+    *p_val = gpio_io_get_fast(p_hndl, gpio);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t
+    io_set_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
+{
+    gpio_io_set_fast(p_hndl, gpio, val);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t io_write_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val)
+{
+    gpio_io_write_bank_fast(p_hndl, mask, val);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t
+    io_read_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_levs)
+{
+    *p_levs = gpio_io_read_bank_fast(p_hndl, mask);
+    return LREC_SUCCESS;
+}
+
+static lr_errc_t
+    io_set_event(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+#if CONFIG_BCM_GPIO_EVENTS
+    volatile uint32_t *p_reg;
+    uint32_t gpio_bit = (uint32_t)1<<(gpio&0x1f);
+
+# define __SET_P_REG(f,r) \
+    p_reg = IO_REG32_PTR(p_hndl->io.p_gpio_io, (r)+sizeof(uint32_t)*(gpio>>5)); \
+    if (event&(f)) *p_reg|=gpio_bit; else *p_reg&=~gpio_bit;
+
+    pthread_mutex_lock(&evt_locks[gpio>>5]);
+    __SET_P_REG(GPIO_EVENT_RAISING, GPREN0);
+    __SET_P_REG(GPIO_EVENT_FALLING, GPFEN0);
+    __SET_P_REG(GPIO_EVENT_BCM_HIGH, GPHEN0);
+    __SET_P_REG(GPIO_EVENT_BCM_LOW, GPLEN0);
+    __SET_P_REG(GPIO_EVENT_BCM_ARAISING, GPAREN0);
+    __SET_P_REG(GPIO_EVENT_BCM_AFALLING, GPAFEN0);
+    pthread_mutex_unlock(&evt_locks[gpio>>5]);
+# undef __SET_P_REG
+    SIM_SYNC(p_hndl);
+#else
+    ret=LREC_NOT_SUPP;
+#endif
+    return ret;
+}
+
+static const gpio_drv_ops_t io_ops =
+{
+    .direction_input = io_direction_input,
+    .direction_output = io_direction_output,
+    .get_value = io_get_value,
+    .set_value = io_set_value,
+    .write_bank = io_write_bank,
+    .read_bank = io_read_bank,
+    .set_event = io_set_event
+};
+
+#if CONFIG_SIM_DRIVER
+/* SIM driver: I/O driver synchronizing the simulator after registers write or
+   before read (GPFSELn writes are synchronized by gpio_bcm_set_func()).
+ */
+static lr_errc_t
+    iosim_get_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_val)
+{
+    sim_sync();
+    return io_get_value(p_hndl, gpio, p_val);
+}
+
+/* Simulated GPSETn/GPCLRn are folded into the output latches on the simulator
+   update. Concurrent writes between updates are accumulated as independent
+   writes to the hardware registers would be.
+ */
+static void iosim_write_reg(gpio_hndl_t *p_hndl, uint32_t reg, uint32_t val)
+{
+    if (val) {
+        __atomic_fetch_or(
+            IO_REG32_PTR(p_hndl->io.p_gpio_io, reg), val, __ATOMIC_RELEASE);
+    }
+}
+
+static lr_errc_t
+    iosim_set_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
 {
-    int i;
+    iosim_write_reg(p_hndl, (val ? GPSET0 : GPCLR0)+sizeof(uint32_t)*(gpio>>5),
+        (uint32_t)1<<(gpio&0x1f));
+    sim_sync();
+    return LREC_SUCCESS;
+}
 
-    p_hndl->drv = (gpio_driver_t)-1;
-    p_hndl->io.p_gpio_io = NULL;
-    for (i=0 ; i<ARRAY_SZ(p_hndl->sysfs.valfds); i++)
-        p_hndl->sysfs.valfds[i]=-1;
+static lr_errc_t iosim_direction_output(
+    gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
+{
+    /* set value at first to avoid output blink */
+    iosim_set_value(p_hndl, gpio, val);
+    return gpio_bcm_set_func(p_hndl, gpio, gpio_bcm_out);
+}
 
-    return gpio_set_driver(p_hndl, drv);
+static lr_errc_t
+    iosim_write_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val)
+{
+    iosim_write_reg(p_hndl, GPSET0, (uint32_t)(mask&val));
+    iosim_write_reg(p_hndl, GPSET1, (uint32_t)((mask&val)>>32));
+    iosim_write_reg(p_hndl, GPCLR0, (uint32_t)(mask&~val));
+    iosim_write_reg(p_hndl, GPCLR1, (uint32_t)((mask&~val)>>32));
+    sim_sync();
+    return LREC_SUCCESS;
 }
 
-/* exported; see header for details */
-lr_errc_t gpio_set_driver(gpio_hndl_t *p_hndl, gpio_driver_t drv)
+static lr_errc_t
+    iosim_read_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_levs)
 {
-    lr_errc_t ret=LREC_SUCCESS;
+    sim_sync();
+    return io_read_bank(p_hndl, mask, p_levs);
+}
 
-    switch (drv)
-    {
-    default:
-        drv = gpio_drv_io;
-        /* fall-through */
+static const gpio_drv_ops_t iosim_ops =
+{
+    .direction_input = io_direction_input,
+    .direction_output = iosim_direction_output,
+    .get_value = iosim_get_value,
+    .set_value = iosim_set_value,
+    .write_bank = iosim_write_bank,
+    .read_bank = iosim_read_bank,
+    .set_event = io_set_event
+};
+#endif /* CONFIG_SIM_DRIVER */
+
+/* SYSFS driver.
+ */
+static lr_errc_t sysfs_direction_input(gpio_hndl_t *p_hndl, unsigned int gpio)
+{
+    return sysfs_set_direction(p_hndl, gpio, FALSE);
+}
 
-    case gpio_drv_io:
-    case gpio_drv_gpio:
-      {
-        if (!p_hndl->io.p_gpio_io)
+static lr_errc_t
+    sysfs_get_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_val)
+{
+    char c;
+    int valfd = p_hndl->sysfs.valfds[gpio];
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (valfd != -1) {
+        if (pread(valfd, &c, 1, 0) != -1)
         {
-            uint32_t io_base = get_bcm_io_base();
-            if (io_base) {
-                if (!(p_hndl->io.p_gpio_io = io_mmap(
-                    (drv == gpio_drv_io ? DEV_MEM_IO : DEV_MEM_GPIO),
-                    io_base+GPIO_BASE_RA, BCM_GPIO_MAP_LEN)))
-                {
-                    ret=LREC_MMAP_ERR;
-                }
-            } else {
-                err_printf("[%s] BCM platform not detected\n", __func__);
-                ret=LREC_PLAT_ERR;
-            }
+            *p_val = (unsigned int)!(c=='0');
         } else {
-            /* already initialized I/O */
+            err_printf("[%s] sysfs gpio-value read error: %d; %s\n",
+                __func__, errno, strerror(errno));
+            ret=LREC_READ_ERR;
         }
-        break;
-      }
-
-    case gpio_drv_sysfs:
-        /* no initialization needed in this case */
-        break;
-    }
+    } else
+        ret=LREC_NOINIT;
 
-    if (ret==LREC_SUCCESS) p_hndl->drv = drv;
     return ret;
 }
 
-/* exported; see header for details */
-void gpio_free(gpio_hndl_t *p_hndl)
+static lr_errc_t
+    sysfs_set_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
 {
-    int i;
-
-    if (p_hndl->drv!=(gpio_driver_t)-1)
-    {
-        /* free I/O driver resources */
-        if (p_hndl->io.p_gpio_io) {
-            munmap((void*)p_hndl->io.p_gpio_io, BCM_GPIO_MAP_LEN);
-            p_hndl->io.p_gpio_io = NULL;
-        }
+    char c = (val ? '1' : '0');
+    int valfd = p_hndl->sysfs.valfds[gpio];
+    lr_errc_t ret=LREC_SUCCESS;
 
-        /* free SYSFS driver resources */
-        for (i=0 ; i<ARRAY_SZ(p_hndl->sysfs.valfds); i++) {
-            if (p_hndl->sysfs.valfds[i] != -1) {
-                close(p_hndl->sysfs.valfds[i]);
-                p_hndl->sysfs.valfds[i] = -1;
-            }
+    if (valfd != -1) {
+        if (write(valfd, &c, 1) == -1)
+        {
+            err_printf("[%s] sysfs gpio-value write error: %d; %s\n",
+                __func__, errno, strerror(errno));
+            ret=LREC_WRITE_ERR;
         }
+    } else
+        ret=LREC_NOINIT;
 
-        /* mark the handle as closed */
-        p_hndl->drv = (gpio_driver_t)-1;
-    }
+    return ret;
 }
 
-#define CHK_GPIO_NUM(n) \
-    if ((n)<0 || (n)>=GPIO_NUM) { ret=LREC_INV_ARG; goto finish; }
+static lr_errc_t sysfs_direction_output(
+    gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
+{
+    lr_errc_t ret;
 
-/* exported; see header for details */
-lr_errc_t gpio_bcm_get_func(
-    gpio_hndl_t *p_hndl, unsigned int gpio, gpio_bcm_func_t *p_func)
+    /* sysfs prevents setting a GPIO value before
+       declaring its direction as an output */
+    if ((ret=sysfs_set_direction(p_hndl, gpio, TRUE))==LREC_SUCCESS)
+        ret = sysfs_set_value(p_hndl, gpio, val);
+    return ret;
+}
+
+static lr_errc_t
+    sysfs_write_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val)
 {
+    unsigned int gpio;
     lr_errc_t ret=LREC_SUCCESS;
 
-    CHK_GPIO_NUM(gpio);
+    for (gpio=0; mask; gpio++, mask>>=1) {
+        if (mask&1)
+            EXEC_RG(sysfs_set_value(p_hndl, gpio, (val>>gpio)&1));
+    }
+finish:
+    return ret;
+}
 
-    if (p_hndl->io.p_gpio_io) {
-        volatile uint32_t *p_gpfsel = IO_REG32_PTR(
-            p_hndl->io.p_gpio_io, GPFSEL0+sizeof(uint32_t)*(gpio/10));
-        *p_func = (gpio_bcm_func_t)((*p_gpfsel>>(3*(gpio%10)))&7);
-    } else
-        ret=LREC_NOINIT;
+static lr_errc_t
+    sysfs_read_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_levs)
+{
+    unsigned int gpio, val;
+    uint64_t levs=0;
+    lr_errc_t ret=LREC_SUCCESS;
 
+    for (gpio=0; (mask>>gpio); gpio++) {
+        if ((mask>>gpio)&1) {
+            EXEC_RG(sysfs_get_value(p_hndl, gpio, &val));
+            if (val) levs|=GPIO_MASK(gpio);
+        }
+    }
+    *p_levs = levs;
 finish:
     return ret;
 }
 
-/* exported; see header for details */
-lr_errc_t gpio_bcm_set_func(
-    gpio_hndl_t *p_hndl, unsigned int gpio, gpio_bcm_func_t func)
+static const gpio_drv_ops_t sysfs_ops =
 {
-    lr_errc_t ret=LREC_SUCCESS;
+    .direction_input = sysfs_direction_input,
+    .direction_output = sysfs_direction_output,
+    .get_value = sysfs_get_value,
+    .set_value = sysfs_set_value,
+    .write_bank = sysfs_write_bank,
+    .read_bank = sysfs_read_bank,
+    .set_event = sysfs_set_event
+};
+
+#if CONFIG_GPIO_CDEV_DRIVER
+/* CDEV driver.
+ */
+static lr_errc_t cdev_direction_input(gpio_hndl_t *p_hndl, unsigned int gpio)
+{
+    return cdev_set_direction(p_hndl, gpio, FALSE, 0);
+}
 
-    CHK_GPIO_NUM(gpio);
+static lr_errc_t cdev_direction_output(
+    gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
+{
+    /* value set along with the direction */
+    return cdev_set_direction(p_hndl, gpio, TRUE, val);
+}
 
-    if (p_hndl->io.p_gpio_io) {
-        unsigned int shl = 3*(gpio%10);
-        volatile uint32_t *p_gpfsel = IO_REG32_PTR(
-            p_hndl->io.p_gpio_io, GPFSEL0+sizeof(uint32_t)*(gpio/10));
-        *p_gpfsel = (volatile uint32_t)SET_BITFLD(
-            *p_gpfsel, ((uint32_t)func&7)<<shl, (uint32_t)7<<shl);
-    } else
-        ret=LREC_NOINIT;
+static lr_errc_t
+    cdev_get_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_val)
+{
+    uint64_t levs;
+    lr_errc_t ret;
 
-finish:
+    if ((ret=cdev_get_values(p_hndl, GPIO_MASK(gpio), &levs))==LREC_SUCCESS)
+        *p_val = GPIO_LEV(levs, gpio);
     return ret;
 }
 
-/* Set GPIO direction on sysfs. If GPIO value sysfs handle is not yet obtained -
-   do it.
- */
 static lr_errc_t
-    sysfs_set_direction(gpio_hndl_t *p_hndl, unsigned int gpio, bool_t as_out)
+    cdev_set_value(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
 {
-    char buf[40];
-    const char *dir_str;
+    return cdev_set_values(
+        p_hndl, GPIO_MASK(gpio), (val ? GPIO_MASK(gpio) : 0));
+}
 
-    int valfd, dirfd=-1;
-    lr_errc_t ret=LREC_SUCCESS;
+static const gpio_drv_ops_t cdev_ops =
+{
+    .direction_input = cdev_direction_input,
+    .direction_output = cdev_direction_output,
+    .get_value = cdev_get_value,
+    .set_value = cdev_set_value,
+    .write_bank = cdev_set_values,
+    .read_bank = cdev_get_values,
+    .set_event = cdev_set_event
+};
+#endif /* CONFIG_GPIO_CDEV_DRIVER */
+
+/* Drivers operations indexed by the driver id; built-in drivers are followed by
+   the registered ones.
+ */
+static const gpio_drv_ops_t *drvs[GPIO_DRV_MAX] =
+{
+    [gpio_drv_io] = &io_ops,
+    [gpio_drv_gpio] = &io_ops,
+    [gpio_drv_sysfs] = &sysfs_ops,
+#if CONFIG_GPIO_CDEV_DRIVER
+    [gpio_drv_cdev] = &cdev_ops,
+#endif
+#if CONFIG_SIM_DRIVER
+    [gpio_drv_sim] = &iosim_ops,
+#endif
+};
 
-    CHK_GPIO_NUM(gpio);
-    valfd = p_hndl->sysfs.valfds[gpio];
+static pthread_mutex_t drvs_lock = PTHREAD_MUTEX_INITIALIZER;
 
-    /* open sysfs GPIO file if not yet done */
-    if (valfd == -1)
-    {
-        sprintf(buf, "/sys/class/gpio/gpio%d/value", gpio);
-        if ((valfd = p_hndl->sysfs.valfds[gpio] = open(buf, O_RDWR)) == -1)
-        {
-            err_printf("[%s] sysfs gpio-value open error: %d; %s\n"
-                "Haven't forget to export the gpio?\n",
-                __func__, errno, strerror(errno));
-            ret=LREC_OPEN_ERR;
-            goto finish;
-        }
-    }
+/* Get driver's operations (NULL if the driver is not present).
+ */
+static const gpio_drv_ops_t *get_drv_ops(gpio_driver_t drv)
+{
+    const gpio_drv_ops_t *p_ops;
 
-    sprintf(buf, "/sys/class/gpio/gpio%d/direction", gpio);
-    if ((dirfd = open(buf, O_WRONLY)) == -1)
+    pthread_mutex_lock(&drvs_lock);
+    p_ops = drvs[drv];
+    pthread_mutex_unlock(&drvs_lock);
+    return p_ops;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_register_driver(const gpio_drv_ops_t *p_ops, gpio_driver_t *p_drv)
+{
+    unsigned int i;
+    lr_errc_t ret=LREC_NO_SPACE;
+
+    if (!p_ops->direction_input || !p_ops->direction_output ||
+        !p_ops->get_value || !p_ops->set_value || !p_ops->write_bank ||
+        !p_ops->read_bank || !p_ops->set_event)
     {
-        err_printf("[%s] sysfs gpio-direction open error: %d; %s\n",
-            __func__, errno, strerror(errno));
-        ret=LREC_OPEN_ERR;
+        ret=LREC_INV_ARG;
         goto finish;
     }
 
-    dir_str = (as_out ? "out" : "in");
-    if (write(dirfd, dir_str, strlen(dir_str)) == -1) {
-        err_printf("[%s] sysfs gpio-direction write error: %d; %s\n",
-            __func__, errno, strerror(errno));
-        ret=LREC_WRITE_ERR;
+    pthread_mutex_lock(&drvs_lock);
+    for (i=gpio_drv_custom; i<GPIO_DRV_MAX; i++) {
+        if (!drvs[i]) {
+            drvs[i] = p_ops;
+            *p_drv = (gpio_driver_t)i;
+            ret=LREC_SUCCESS;
+            break;
+        }
     }
-
+    pthread_mutex_unlock(&drvs_lock);
 finish:
-    if (dirfd != -1) close(dirfd);
     return ret;
 }
 
 /* exported; see header for details */
 lr_errc_t gpio_direction_input(gpio_hndl_t *p_hndl, unsigned int gpio)
 {
-    lr_errc_t ret;
+    lr_errc_t ret=LREC_SUCCESS;
 
-    if (p_hndl->drv==gpio_drv_io || p_hndl->drv==gpio_drv_gpio) {
-        ret = gpio_bcm_set_func(p_hndl, gpio, gpio_bcm_in);
-    } else {
-        ret = sysfs_set_direction(p_hndl, gpio, FALSE);
-    }
+    CHK_GPIO_NUM(gpio);
+    CHK_DRV(p_hndl);
+    ret = p_hndl->p_ops->direction_input(p_hndl, gpio);
+finish:
     return ret;
 }
 
@@ -216,18 +1341,12 @@ lr_errc_t gpio_direction_input(gpio_hndl_t *p_hndl, unsigned int gpio)
 lr_errc_t gpio_direction_output(
     gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
 {
-    lr_errc_t ret;
+    lr_errc_t ret=LREC_SUCCESS;
 
-    if (p_hndl->drv==gpio_drv_io || p_hndl->drv==gpio_drv_gpio) {
-        /* set value at first to avoid output blink */
-        if ((ret=gpio_set_value(p_hndl, gpio, val))==LREC_SUCCESS)
-            ret = gpio_bcm_set_func(p_hndl, gpio, gpio_bcm_out);
-    } else {
-        /* sysfs prevents setting a GPIO value before
-           declaring its direction as an output */
-        if ((ret=sysfs_set_direction(p_hndl, gpio, TRUE))==LREC_SUCCESS)
-            ret = gpio_set_value(p_hndl, gpio, val);
-    }
+    CHK_GPIO_NUM(gpio);
+    CHK_DRV(p_hndl);
+    ret = p_hndl->p_ops->direction_output(p_hndl, gpio, val);
+finish:
     return ret;
 }
 
@@ -238,28 +1357,8 @@ lr_errc_t gpio_get_value(
     lr_errc_t ret=LREC_SUCCESS;
 
     CHK_GPIO_NUM(gpio);
-
-    if (p_hndl->drv==gpio_drv_io || p_hndl->drv==gpio_drv_gpio) {
-        volatile uint32_t *p_gplev = IO_REG32_PTR(
-            p_hndl->io.p_gpio_io, GPLEV0+sizeof(uint32_t)*(gpio>>5));
-        *p_val = (unsigned int)((*p_gplev>>(gpio&0x1f))&1);
-    } else
-    {
-        char c;
-        int valfd = p_hndl->sysfs.valfds[gpio];
-
-        if (valfd != -1) {
-            if (lseek(valfd, 0, SEEK_SET)!=-1 && read(valfd, &c, 1) != -1)
-            {
-                *p_val = (unsigned int)!(c=='0');
-            } else {
-                err_printf("[%s] sysfs gpio-value read error: %d; %s\n",
-                    __func__, errno, strerror(errno));
-                ret=LREC_READ_ERR;
-            }
-        } else
-            ret=LREC_NOINIT;
-    }
+    CHK_DRV(p_hndl);
+    ret = p_hndl->p_ops->get_value(p_hndl, gpio, p_val);
 finish:
     return ret;
 }
@@ -271,130 +1370,123 @@ lr_errc_t
     lr_errc_t ret=LREC_SUCCESS;
 
     CHK_GPIO_NUM(gpio);
+    CHK_DRV(p_hndl);
+    ret = p_hndl->p_ops->set_value(p_hndl, gpio, val);
+finish:
+    return ret;
+}
 
-    if (p_hndl->drv==gpio_drv_io || p_hndl->drv==gpio_drv_gpio) {
-        volatile uint32_t *p_gpsetclr = IO_REG32_PTR(p_hndl->io.p_gpio_io,
-            (val ? GPSET0 : GPCLR0)+sizeof(uint32_t)*(gpio>>5));
-        *p_gpsetclr = (uint32_t)1<<(gpio&0x1f);
-    } else
-    {
-        char c = (val ? '1' : '0');
-        int valfd = p_hndl->sysfs.valfds[gpio];
+/* exported; see header for details */
+lr_errc_t
+    gpio_write_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val)
+{
+    lr_errc_t ret=LREC_SUCCESS;
 
-        if (valfd != -1) {
-            if (write(valfd, &c, 1) == -1)
-            {
-                err_printf("[%s] sysfs gpio-value write error: %d; %s\n",
-                    __func__, errno, strerror(errno));
-                ret=LREC_WRITE_ERR;
-            }
-        } else
-            ret=LREC_NOINIT;
-    }
+    CHK_GPIO_MASK(mask);
+    CHK_DRV(p_hndl);
+    ret = p_hndl->p_ops->write_bank(p_hndl, mask, val);
 finish:
     return ret;
 }
 
-/* Set GPIO event on sysfs.
- */
-static lr_errc_t
-    sysfs_set_event(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event)
+/* exported; see header for details */
+lr_errc_t gpio_set_mask(gpio_hndl_t *p_hndl, uint64_t mask)
 {
-    char buf[40];
-    const char *ev_str;
+    return gpio_write_bank(p_hndl, mask, GPIO_MASK_ALL);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_clr_mask(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    return gpio_write_bank(p_hndl, mask, 0);
+}
 
-    int evfd=-1;
+/* exported; see header for details */
+lr_errc_t gpio_read_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_levs)
+{
     lr_errc_t ret=LREC_SUCCESS;
 
-    CHK_GPIO_NUM(gpio);
+    CHK_GPIO_MASK(mask);
+    CHK_DRV(p_hndl);
+    ret = p_hndl->p_ops->read_bank(p_hndl, mask, p_levs);
+finish:
+    return ret;
+}
 
-    sprintf(buf, "/sys/class/gpio/gpio%d/edge", gpio);
-    if ((evfd = open(buf, O_WRONLY)) == -1)
-    {
-        err_printf("[%s] sysfs gpio-edge open error: %d; %s\n"
-            "Haven't forget to export the gpio?\n",
-            __func__, errno, strerror(errno));
-        ret=LREC_OPEN_ERR;
-        goto finish;
-    }
+/* exported; see header for details */
+lr_errc_t gpio_set_event(
+    gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event)
+{
+    lr_errc_t ret=LREC_SUCCESS;
 
-    if (event==GPIO_EVENT_NONE) {
-        ev_str = "none";
-    } else
-    if ((event&GPIO_EVENT_RAISING)!=0 && (event&GPIO_EVENT_FALLING)!=0) {
-        ev_str = "both";
-    } else
-    if ((event&GPIO_EVENT_RAISING)!=0) {
-        ev_str = "rising";
-    } else
-    if ((event&GPIO_EVENT_FALLING)!=0) {
-        ev_str = "falling";
-    } else {
-        ret=LREC_INV_ARG;
-        goto finish;
-    }
+    CHK_GPIO_NUM(gpio);
+    CHK_DRV(p_hndl);
+    ret = p_hndl->p_ops->set_event(p_hndl, gpio, event);
+finish:
+    return ret;
+}
 
-    if (write(evfd, ev_str, strlen(ev_str)) == -1) {
-        err_printf("[%s] sysfs gpio-edge write error: %d; %s\n",
-            __func__, errno, strerror(errno));
-        ret=LREC_WRITE_ERR;
+#if CONFIG_BCM_GPIO_EVENTS
+/* Read and clear detected events of 'mask' GPIOs; return the events mask.
+ */
+static uint64_t io_get_events(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    uint64_t eds=0;
+
+    SIM_SYNC(p_hndl);
+    if ((uint32_t)mask)
+        eds = *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPEDS0);
+    if ((uint32_t)(mask>>32))
+        eds |= (uint64_t)*IO_REG32_PTR(p_hndl->io.p_gpio_io, GPEDS1)<<32;
+    eds &= mask;
+
+    /* acknowledge (write-1-to-clear) the detected events */
+    if (eds) {
+# if CONFIG_SIM_DRIVER
+        if (p_hndl->io.sim) sim_ack_events(eds); else
+# endif
+        {
+            if ((uint32_t)eds)
+                *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPEDS0) = (uint32_t)eds;
+            if ((uint32_t)(eds>>32))
+                *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPEDS1) =
+                    (uint32_t)(eds>>32);
+        }
     }
-
-finish:
-    if (evfd != -1) close(evfd);
-    return ret;
+    return eds;
 }
+#endif
 
 /* exported; see header for details */
-lr_errc_t gpio_set_event(
-    gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event)
+lr_errc_t gpio_bcm_get_event_stat(
+    gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_stat)
 {
+    uint64_t pend;
     lr_errc_t ret=LREC_SUCCESS;
 
     CHK_GPIO_NUM(gpio);
 
-    if (p_hndl->drv==gpio_drv_io || p_hndl->drv==gpio_drv_gpio) {
-#if CONFIG_BCM_GPIO_EVENTS
-        volatile uint32_t *p_reg;
-        uint32_t gpio_bit = (uint32_t)1<<(gpio&0x1f);
-
-# define __SET_P_REG(f,r) \
-    p_reg = IO_REG32_PTR(p_hndl->io.p_gpio_io, (r)+sizeof(uint32_t)*(gpio>>5)); \
-    if (event&(f)) *p_reg|=gpio_bit; else *p_reg&=~gpio_bit;
-
-        __SET_P_REG(GPIO_EVENT_RAISING, GPREN0);
-        __SET_P_REG(GPIO_EVENT_FALLING, GPFEN0);
-        __SET_P_REG(GPIO_EVENT_BCM_HIGH, GPHEN0);
-        __SET_P_REG(GPIO_EVENT_BCM_LOW, GPLEN0);
-        __SET_P_REG(GPIO_EVENT_BCM_ARAISING, GPAREN0);
-        __SET_P_REG(GPIO_EVENT_BCM_AFALLING, GPAFEN0);
-# undef __SET_P_REG
-#else
-        ret=LREC_NOT_SUPP;
-#endif
-    } else {
-        ret = sysfs_set_event(p_hndl, gpio, event);
+    if ((ret=gpio_bcm_get_events(
+        p_hndl, GPIO_MASK(gpio), &pend))==LREC_SUCCESS)
+    {
+        *p_stat = (pend!=0);
     }
 finish:
     return ret;
 }
 
 /* exported; see header for details */
-lr_errc_t gpio_bcm_get_event_stat(
-    gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_stat)
+lr_errc_t gpio_bcm_get_events(
+    gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_pend)
 {
     lr_errc_t ret=LREC_SUCCESS;
 
-    CHK_GPIO_NUM(gpio);
+    CHK_GPIO_MASK(mask);
 
     if (p_hndl->io.p_gpio_io)
     {
 #if CONFIG_BCM_GPIO_EVENTS
-        volatile uint32_t *p_gpeds = IO_REG32_PTR(
-            p_hndl->io.p_gpio_io, GPEDS0+sizeof(uint32_t)*(gpio>>5));
-        *p_stat = (unsigned int)((*p_gpeds>>(gpio&0x1f))&1);
-        /* clear status of the detected event */
-        if (*p_stat) *p_gpeds = (uint32_t)1<<(gpio&0x1f);
+        *p_pend = io_get_events(p_hndl, mask);
 #else
         ret=LREC_NOT_SUPP;
 #endif
@@ -405,6 +1497,25 @@ finish:
     return ret;
 }
 
+/* exported; see header for details */
+lr_errc_t gpio_bcm_dispatch_events(gpio_hndl_t *p_hndl, uint64_t mask,
+    const gpio_bcm_event_hndlr_t *p_hndlrs, uint64_t *p_pend)
+{
+    uint64_t pend, evs;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    EXEC_RG(gpio_bcm_get_events(p_hndl, mask, &pend));
+
+    for (evs=pend; evs; evs&=evs-1) {
+        unsigned int gpio = __builtin_ctzll(evs);
+        if (p_hndlrs[gpio].cb)
+            p_hndlrs[gpio].cb(p_hndl, gpio, p_hndlrs[gpio].arg);
+    }
+    if (p_pend) *p_pend = pend;
+finish:
+    return ret;
+}
+
 /* exported; see header for details */
 lr_errc_t gpio_bcm_set_pull_config(
     gpio_hndl_t *p_hndl, unsigned int gpio, gpio_bcm_pull_t pull)
@@ -412,26 +1523,193 @@ lr_errc_t gpio_bcm_set_pull_config(
     lr_errc_t ret=LREC_SUCCESS;
 
     CHK_GPIO_NUM(gpio);
+    ret = gpio_bcm_set_pull_many(p_hndl, GPIO_MASK(gpio), pull);
+finish:
+    return ret;
+}
 
-    if (p_hndl->io.p_gpio_io)
+/* Number of BCM2711 GPIO_PUP_PDN_CNTRL_REGn registers */
+#define PUP_PDN_CNTRL_NUM   ((GPIO_NUM+15)/16)
+
+/* exported; see header for details */
+lr_errc_t gpio_bcm_set_pull_many(
+    gpio_hndl_t *p_hndl, uint64_t mask, gpio_bcm_pull_t pull)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(mask);
+
+    if (!p_hndl->io.p_gpio_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    if (!mask) goto finish;
+
+    pthread_mutex_lock(&pull_lock);
+    if (p_hndl->io.plat==bcm_2711)
+    {
+        unsigned int i, gpio;
+        /* BCM2711 encoding: 0b00: off, 0b01: pull-up, 0b10: pull-down */
+        uint32_t val = (pull==gpio_bcm_pull_up ? 1 :
+            (pull==gpio_bcm_pull_down ? 2 : 0));
+
+        for (i=0; i<PUP_PDN_CNTRL_NUM; i++)
+        {
+            volatile uint32_t *p_cntrl;
+            uint32_t sel=0, msk=0, m16 = (uint32_t)(mask>>(16*i))&0xffff;
+
+            if (!m16) continue;
+
+            for (gpio=0; (m16>>gpio); gpio++) {
+                if ((m16>>gpio)&1) {
+                    sel |= val<<(2*gpio);
+                    msk |= (uint32_t)3<<(2*gpio);
+                }
+            }
+            p_cntrl = IO_REG32_PTR(p_hndl->io.p_gpio_io,
+                GPIO_PUP_PDN_CNTRL_REG0+sizeof(uint32_t)*i);
+            *p_cntrl = (volatile uint32_t)SET_BITFLD(*p_cntrl, sel, msk);
+        }
+    } else
     {
         volatile uint32_t *p_gppud = IO_REG32_PTR(p_hndl->io.p_gpio_io, GPPUD);
-        volatile uint32_t *p_gppudclk = IO_REG32_PTR(
-            p_hndl->io.p_gpio_io, GPPUDCLK0+sizeof(uint32_t)*(gpio>>5));
-        uint32_t gpio_bit = (uint32_t)1<<(gpio&0x1f);
+        volatile uint32_t *p_gppudclk0 =
+            IO_REG32_PTR(p_hndl->io.p_gpio_io, GPPUDCLK0);
+        volatile uint32_t *p_gppudclk1 =
+            IO_REG32_PTR(p_hndl->io.p_gpio_io, GPPUDCLK1);
 
         /* set the required control signal */
         *p_gppud = (uint32_t)pull%3;
         WAIT_CYCLES(150);
-        /* clock the control signal into the GPIO pad */
-        *p_gppudclk = gpio_bit;
+        /* clock the control signal into the GPIOs pads */
+        if ((uint32_t)mask) *p_gppudclk0 = (uint32_t)mask;
+        if ((uint32_t)(mask>>32)) *p_gppudclk1 = (uint32_t)(mask>>32);
         WAIT_CYCLES(150);
         /* remove the control signal and the clock */
         *p_gppud = 0;
-        *p_gppudclk = 0;
-    } else {
+        *p_gppudclk0 = 0;
+        *p_gppudclk1 = 0;
+    }
+    pthread_mutex_unlock(&pull_lock);
+    SIM_SYNC(p_hndl);
+finish:
+    return ret;
+}
+
+/* Read/write 64-bit value from/to a pair of consecutive BCM's GPIO registers.
+ */
+#define IO_READ_REG64(p_io, r) \
+    ((uint64_t)*IO_REG32_PTR((p_io), (r)) | \
+    ((uint64_t)*IO_REG32_PTR((p_io), (r)+sizeof(uint32_t))<<32))
+
+#define IO_WRITE_REG64(p_io, r, v) \
+    if ((uint32_t)(v)) *IO_REG32_PTR((p_io), (r)) = (uint32_t)(v); \
+    if ((uint32_t)((v)>>32)) \
+        *IO_REG32_PTR((p_io), (r)+sizeof(uint32_t)) = (uint32_t)((v)>>32);
+
+/* Get mask of GPIOs configured as outputs by GPFSELn registers 'p_gpfsel'.
+ */
+static uint64_t gpfsel_outs(const uint32_t *p_gpfsel)
+{
+    unsigned int gpio;
+    uint64_t outs=0;
+
+    for (gpio=0; gpio<GPIO_NUM; gpio++) {
+        if (((p_gpfsel[gpio/10]>>(3*(gpio%10)))&7)==gpio_bcm_out)
+            outs |= GPIO_MASK(gpio);
+    }
+    return outs;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_bcm_save_ctx(gpio_hndl_t *p_hndl, gpio_bcm_ctx_t *p_ctx)
+{
+    unsigned int i;
+    volatile void *p_io = p_hndl->io.p_gpio_io;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!p_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    memset(p_ctx, 0, sizeof(*p_ctx));
+    SIM_SYNC(p_hndl);
+
+    for (i=0; i<GPFSEL_NUM; i++)
+        p_ctx->gpfsel[i] = *IO_REG32_PTR(p_io, GPFSEL0+sizeof(uint32_t)*i);
+
+    /* output latches are not readable; take outputs levels */
+    p_ctx->levs = IO_READ_REG64(p_io, GPLEV0) & gpfsel_outs(p_ctx->gpfsel);
+
+    p_ctx->ren  = IO_READ_REG64(p_io, GPREN0);
+    p_ctx->fen  = IO_READ_REG64(p_io, GPFEN0);
+    p_ctx->hen  = IO_READ_REG64(p_io, GPHEN0);
+    p_ctx->len  = IO_READ_REG64(p_io, GPLEN0);
+    p_ctx->aren = IO_READ_REG64(p_io, GPAREN0);
+    p_ctx->afen = IO_READ_REG64(p_io, GPAFEN0);
+
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_bcm_restore_ctx(gpio_hndl_t *p_hndl, const gpio_bcm_ctx_t *p_ctx)
+{
+    unsigned int i;
+    uint32_t gpfsel[GPFSEL_NUM];
+    uint64_t outs, diff;
+    volatile void *p_io = p_hndl->io.p_gpio_io;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!p_io) {
         ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    SIM_SYNC(p_hndl);
+    for (i=0; i<GPFSEL_NUM; i++)
+        gpfsel[i] = *IO_REG32_PTR(p_io, GPFSEL0+sizeof(uint32_t)*i);
+
+    /* output levels to set: outputs of the context which are not outputs at
+       the moment (unknown latches) or have different levels */
+    outs = gpfsel_outs(p_ctx->gpfsel);
+    diff = outs & (~gpfsel_outs(gpfsel) |
+        (IO_READ_REG64(p_io, GPLEV0) ^ p_ctx->levs));
+
+    IO_WRITE_REG64(p_io, GPSET0, diff & p_ctx->levs);
+    IO_WRITE_REG64(p_io, GPCLR0, diff & ~p_ctx->levs);
+
+    for (i=0; i<GPFSEL_NUM; i++) {
+        if (gpfsel[i] != p_ctx->gpfsel[i]) {
+            pthread_mutex_lock(&fsel_locks[i]);
+            *IO_REG32_PTR(p_io, GPFSEL0+sizeof(uint32_t)*i) = p_ctx->gpfsel[i];
+            pthread_mutex_unlock(&fsel_locks[i]);
+        }
     }
+
+#if CONFIG_BCM_GPIO_EVENTS
+# define __RESTORE_REG(r, f) \
+    for (i=0; i<2; i++) { \
+        volatile uint32_t *p_reg = IO_REG32_PTR(p_io, (r)+sizeof(uint32_t)*i); \
+        uint32_t val = (uint32_t)(p_ctx->f>>(32*i)); \
+        if (*p_reg != val) *p_reg = val; \
+    }
+
+    pthread_mutex_lock(&evt_locks[0]);
+    pthread_mutex_lock(&evt_locks[1]);
+    __RESTORE_REG(GPREN0, ren);
+    __RESTORE_REG(GPFEN0, fen);
+    __RESTORE_REG(GPHEN0, hen);
+    __RESTORE_REG(GPLEN0, len);
+    __RESTORE_REG(GPAREN0, aren);
+    __RESTORE_REG(GPAFEN0, afen);
+    pthread_mutex_unlock(&evt_locks[1]);
+    pthread_mutex_unlock(&evt_locks[0]);
+# undef __RESTORE_REG
+#endif
+    SIM_SYNC(p_hndl);
+
 finish:
     return ret;
 }
@@ -450,6 +1728,9 @@ static lr_errc_t
     CHK_GPIO_NUM(gpio);
     expstr = (export ? "export" : "unexport");
 
+    /* the GPIO sysfs attributes are removed on unexport */
+    if (!export) sysfs_close(p_hndl, gpio);
+
     sprintf(buf, "/sys/class/gpio/%s", expstr);
     if ((expfd = open(buf, O_WRONLY)) == -1)
     {
@@ -485,6 +1766,80 @@ lr_errc_t gpio_sysfs_unexport(gpio_hndl_t *p_hndl, unsigned int gpio)
     return sysfs_set_export(p_hndl, gpio, FALSE);
 }
 
+/* exported; see header for details */
+lr_errc_t gpio_sysfs_export_many(
+    gpio_hndl_t *p_hndl, uint64_t mask, int timeout)
+{
+    int expfd=-1;
+    unsigned int gpio;
+    uint64_t pend, start;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    char buf[32];
+
+    CHK_GPIO_MASK(mask);
+
+    if ((expfd = open("/sys/class/gpio/export", O_WRONLY)) == -1)
+    {
+        err_printf("[%s] sysfs gpio-export open error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_OPEN_ERR;
+        goto finish;
+    }
+
+    for (gpio=0; (mask>>gpio); gpio++)
+    {
+        if (!((mask>>gpio)&1)) continue;
+
+        /* exporting already exported GPIO is not an error */
+        if (write(expfd, buf, sprintf(buf, "%d", gpio))==-1 && errno!=EBUSY)
+        {
+            err_printf("[%s] sysfs gpio-export write error: %d; %s\n",
+                __func__, errno, strerror(errno));
+            ret=LREC_WRITE_ERR;
+            goto finish;
+        }
+    }
+
+    /* wait for the access rights to the exported GPIOs attributes */
+    for (pend=mask, start=time_ns();;)
+    {
+        for (gpio=0; (pend>>gpio); gpio++)
+        {
+            int *p_valfd = &p_hndl->sysfs.valfds[gpio];
+            int *p_dirfd = &p_hndl->sysfs.dirfds[gpio];
+
+            if (!((pend>>gpio)&1)) continue;
+
+            if (*p_valfd == -1)
+                *p_valfd = sysfs_open_attr(gpio, "value", O_RDWR);
+            if (*p_dirfd == -1)
+                *p_dirfd = sysfs_open_attr(gpio, "direction", O_WRONLY);
+
+            if (*p_valfd != -1 && *p_dirfd != -1) {
+                pend &= ~GPIO_MASK(gpio);
+            } else
+            if (errno!=EACCES && errno!=ENOENT) {
+                err_printf("[%s] sysfs gpio-%d open error: %d; %s\n",
+                    __func__, gpio, errno, strerror(errno));
+                ret=LREC_OPEN_ERR;
+                goto finish;
+            }
+        }
+
+        if (!pend) break;
+        if (timeout>=0 && time_ns()-start >= (uint64_t)timeout*1000000U) {
+            ret=LREC_TIMEOUT;
+            break;
+        }
+        usleep(1000);
+    }
+
+finish:
+    if (expfd != -1) close(expfd);
+    return ret;
+}
+
 /* exported; see header for details */
 lr_errc_t gpio_sysfs_poll(gpio_hndl_t *p_hndl, unsigned int gpio, int timeout)
 {
@@ -504,8 +1859,7 @@ lr_errc_t gpio_sysfs_poll(gpio_hndl_t *p_hndl, unsigned int gpio, int timeout)
     }
 
     /* purge sysfs handle from pending data */
-    lseek(fds.fd, 0, SEEK_SET);
-    while (read(fds.fd, &tmp, sizeof(tmp))>0);
+    pread(fds.fd, &tmp, sizeof(tmp), 0);
 
     plres = poll(&fds, 1, timeout);
     if (plres<0) {
@@ -520,3 +1874,231 @@ lr_errc_t gpio_sysfs_poll(gpio_hndl_t *p_hndl, unsigned int gpio, int timeout)
 finish:
     return ret;
 }
+
+/* exported; see header for details */
+lr_errc_t gpio_cdev_set_chip(gpio_hndl_t *p_hndl, const char *chip)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (strlen(chip)>=sizeof(p_hndl->cdev.chip)) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+
+    cdev_close_chip(p_hndl);
+    strcpy(p_hndl->cdev.chip, chip);
+    memset(p_hndl->cdev.flags, 0, sizeof(p_hndl->cdev.flags));
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_cdev_request(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(mask);
+
+#if CONFIG_GPIO_CDEV_DRIVER
+    {
+        unsigned int gpio;
+
+        mask &= ~p_hndl->cdev.lines;
+        if (!mask) goto finish;
+
+        /* newly requested lines are inputs */
+        for (gpio=0; (mask>>gpio); gpio++) {
+            if ((mask>>gpio)&1)
+                p_hndl->cdev.flags[gpio] = GPIO_V2_LINE_FLAG_INPUT;
+        }
+        ret = cdev_request_lines(p_hndl, p_hndl->cdev.lines|mask);
+    }
+#else
+    ret=LREC_NOT_SUPP;
+#endif
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_cdev_release(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(mask);
+
+#if CONFIG_GPIO_CDEV_DRIVER
+    {
+        unsigned int gpio;
+
+        mask &= p_hndl->cdev.lines;
+        if (!mask) goto finish;
+
+        for (gpio=0; (mask>>gpio); gpio++) {
+            if ((mask>>gpio)&1) p_hndl->cdev.flags[gpio] = 0;
+        }
+        ret = cdev_request_lines(p_hndl, p_hndl->cdev.lines&~mask);
+    }
+#else
+    ret=LREC_NOT_SUPP;
+#endif
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_cdev_set_config(
+    gpio_hndl_t *p_hndl, uint64_t mask, unsigned int cfg)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(mask);
+
+#if CONFIG_GPIO_CDEV_DRIVER
+    {
+        unsigned int gpio;
+        uint64_t flags=0;
+
+        CHK_CDEV_LINES(mask);
+
+        switch (cfg & 0x0f)
+        {
+        case GPIO_CDEV_BIAS_AS_IS:
+            break;
+        case GPIO_CDEV_BIAS_DISABLED:
+            flags |= GPIO_V2_LINE_FLAG_BIAS_DISABLED;
+            break;
+        case GPIO_CDEV_BIAS_PULL_DOWN:
+            flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN;
+            break;
+        case GPIO_CDEV_BIAS_PULL_UP:
+            flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+            break;
+        default:
+            ret=LREC_INV_ARG;
+            goto finish;
+        }
+
+        switch (cfg & ~0x0f)
+        {
+        case GPIO_CDEV_DRIVE_PUSH_PULL:
+            break;
+        case GPIO_CDEV_DRIVE_OPEN_DRAIN:
+            flags |= GPIO_V2_LINE_FLAG_OPEN_DRAIN;
+            break;
+        case GPIO_CDEV_DRIVE_OPEN_SOURCE:
+            flags |= GPIO_V2_LINE_FLAG_OPEN_SOURCE;
+            break;
+        default:
+            ret=LREC_INV_ARG;
+            goto finish;
+        }
+
+        for (gpio=0; (mask>>gpio); gpio++) {
+            if ((mask>>gpio)&1) {
+                p_hndl->cdev.flags[gpio] = SET_BITFLD(p_hndl->cdev.flags[gpio],
+                    flags, CDEV_BIAS_FLAGS|CDEV_DRIVE_FLAGS);
+            }
+        }
+        if (mask) ret = cdev_set_config(p_hndl);
+    }
+#else
+    ret=LREC_NOT_SUPP;
+#endif
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_cdev_set_event_buf(gpio_hndl_t *p_hndl, unsigned int n_evs)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+#if CONFIG_GPIO_CDEV_DRIVER
+    p_hndl->cdev.ev_bufsz = n_evs;
+    if (p_hndl->cdev.lines)
+        ret = cdev_request_lines(p_hndl, p_hndl->cdev.lines);
+#else
+    ret=LREC_NOT_SUPP;
+#endif
+    return ret;
+}
+
+/* max number of kernel events read by a single read() call */
+#define CDEV_EVS_CHUNK  64
+
+/* exported; see header for details */
+lr_errc_t gpio_cdev_read_events(gpio_hndl_t *p_hndl,
+    gpio_event_t *p_evs, size_t n_evs, size_t *p_n_read, int timeout)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    *p_n_read = 0;
+
+#if CONFIG_GPIO_CDEV_DRIVER
+    {
+        int plres;
+        ssize_t rdres;
+        size_t i, n, n_req;
+        struct pollfd fds;
+        struct gpio_v2_line_event kevs[CDEV_EVS_CHUNK];
+
+        if (p_hndl->cdev.reqfd == -1) {
+            ret=LREC_NOINIT;
+            goto finish;
+        }
+
+        fds.fd = p_hndl->cdev.reqfd;
+        fds.events = POLLIN;
+        fds.revents = 0;
+
+        plres = poll(&fds, 1, timeout);
+        if (plres<0) {
+            err_printf("[%s] poll() error: %d; %s\n",
+                __func__, errno, strerror(errno));
+            ret=LREC_POLL_ERR;
+            goto finish;
+        } else
+        if (!plres) {
+            ret=LREC_TIMEOUT;
+            goto finish;
+        }
+
+        /* drain pending events */
+        while (*p_n_read < n_evs)
+        {
+            n_req = MIN(n_evs-*p_n_read, ARRAY_SZ(kevs));
+
+            rdres = read(fds.fd, kevs, n_req*sizeof(kevs[0]));
+            if (rdres<0) {
+                if (errno==EAGAIN || errno==EWOULDBLOCK) break;
+                err_printf("[%s] GPIO events read error: %d; %s\n",
+                    __func__, errno, strerror(errno));
+                ret=LREC_READ_ERR;
+                goto finish;
+            }
+
+            n = (size_t)rdres/sizeof(kevs[0]);
+            for (i=0; i<n; i++, p_evs++) {
+                p_evs->ts = kevs[i].timestamp_ns;
+                p_evs->seqno = kevs[i].seqno;
+                p_evs->line_seqno = kevs[i].line_seqno;
+                p_evs->gpio = kevs[i].offset;
+                p_evs->event =
+                    (kevs[i].id==GPIO_V2_LINE_EVENT_RISING_EDGE ?
+                    GPIO_EVENT_RAISING : GPIO_EVENT_FALLING);
+            }
+            *p_n_read += n;
+
+            /* no more events pending */
+            if (n < n_req) break;
+        }
+
+        if (!*p_n_read) ret=LREC_TIMEOUT;
+    }
+finish:
+#else
+    ret=LREC_NOT_SUPP;
+#endif
+    return ret;
+}
@@ -0,0 +1,374 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "librasp/gpio_cnt.h"
+
+/* seqlock protected fields access */
+#define SEQ_STORE(v, x)     __atomic_store_n(&(v), (x), __ATOMIC_RELAXED)
+#define SEQ_LOAD(v)         __atomic_load_n(&(v), __ATOMIC_RELAXED)
+
+/* exported; see header for details */
+lr_errc_t gpio_cnt_init(gpio_cnt_t *p_cnt, gpio_hndl_t *p_gpio_h,
+    gpio_cnt_src_t src, uint32_t rate, uint32_t win)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_cnt, 0, sizeof(*p_cnt));
+
+    if ((src!=gpio_cnt_cdev && src!=gpio_cnt_bcm) || !win ||
+        (src==gpio_cnt_bcm && (!rate || rate>1000000000U)))
+    {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+#if !CONFIG_BCM_GPIO_EVENTS
+    if (src==gpio_cnt_bcm) {
+        ret=LREC_NOT_SUPP;
+        goto finish;
+    }
+#endif
+    if (src==gpio_cnt_bcm && !p_gpio_h->io.p_gpio_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    p_cnt->p_gpio_h = p_gpio_h;
+    p_cnt->src = src;
+    p_cnt->period = (src==gpio_cnt_bcm ? 1000000000U/rate : 0);
+    p_cnt->slot_len = (uint64_t)win*1000000U/GPIO_CNT_SLOTS;
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_cnt_free(gpio_cnt_t *p_cnt)
+{
+    gpio_cnt_stop(p_cnt);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_cnt_add(gpio_cnt_t *p_cnt, unsigned int gpio, unsigned int edge)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+    if (edge!=GPIO_EVENT_RAISING && edge!=GPIO_EVENT_FALLING &&
+        edge!=GPIO_EVENT_BOTH)
+    {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (p_cnt->run) {
+        ret=LREC_NOT_SUPP;
+        goto finish;
+    }
+
+    EXEC_RG(gpio_set_event(p_cnt->p_gpio_h, gpio, edge));
+
+    p_cnt->cnts[gpio].edge = edge;
+    p_cnt->pins |= GPIO_MASK(gpio);
+finish:
+    return ret;
+}
+
+/* Publish counted GPIO state (seqlock write).
+ */
+static void cnt_publish(gpio_cnt_pin_t *p_pin,
+    uint64_t count, uint64_t first_ts, uint64_t last_ts, uint64_t freq)
+{
+    uint32_t seq = p_pin->seq;
+
+    SEQ_STORE(p_pin->seq, seq+1);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    SEQ_STORE(p_pin->count, count);
+    SEQ_STORE(p_pin->first_ts, first_ts);
+    SEQ_STORE(p_pin->last_ts, last_ts);
+    SEQ_STORE(p_pin->freq, freq);
+
+    __atomic_store_n(&p_pin->seq, seq+2, __ATOMIC_RELEASE);
+}
+
+/* Counter thread private state of a GPIO (the published state copy).
+ */
+typedef struct _cnt_priv_t
+{
+    uint64_t count;
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint64_t freq;
+} cnt_priv_t;
+
+/* Count 'n' edges of 'gpio' at 'ts'.
+ */
+#define CNT_EDGES(p_cnt, privs, slot, gpio, n, ts) \
+    privs[gpio].count += (n); \
+    if (!privs[gpio].first_ts) privs[gpio].first_ts = (ts); \
+    privs[gpio].last_ts = (ts); \
+    (p_cnt)->cnts[gpio].slots[slot] += (uint32_t)(n);
+
+/* Publish states of GPIOs specified by 'mask'.
+ */
+static void cnt_publish_mask(gpio_cnt_t *p_cnt, cnt_priv_t *p_privs, uint64_t mask)
+{
+    unsigned int gpio;
+
+    for (; mask; mask&=mask-1) {
+        gpio = __builtin_ctzll(mask);
+        cnt_publish(&p_cnt->cnts[gpio], p_privs[gpio].count,
+            p_privs[gpio].first_ts, p_privs[gpio].last_ts, p_privs[gpio].freq);
+    }
+}
+
+/* Move the sliding window up to 'now'. Frequencies of all the GPIOs are
+   recalculated and published on each completed slot.
+ */
+static void cnt_slide(gpio_cnt_t *p_cnt, cnt_priv_t *p_privs,
+    uint64_t now, uint64_t start, uint64_t *p_slot_end, unsigned int *p_slot)
+{
+    unsigned int gpio, i;
+    uint64_t mask, win_len;
+
+    if (now < *p_slot_end) return;
+
+    do {
+        *p_slot_end += p_cnt->slot_len;
+        *p_slot = (*p_slot+1) % GPIO_CNT_SLOTS;
+        for (mask=p_cnt->pins; mask; mask&=mask-1)
+            p_cnt->cnts[__builtin_ctzll(mask)].slots[*p_slot] = 0;
+    } while (now >= *p_slot_end);
+
+    /* window covered by the completed slots */
+    win_len = MIN(*p_slot_end-p_cnt->slot_len-start,
+        p_cnt->slot_len*(GPIO_CNT_SLOTS-1));
+
+    for (mask=p_cnt->pins; mask; mask&=mask-1)
+    {
+        uint64_t sum=0;
+        gpio_cnt_pin_t *p_pin;
+
+        gpio = __builtin_ctzll(mask);
+        p_pin = &p_cnt->cnts[gpio];
+
+        for (i=0; i<GPIO_CNT_SLOTS; i++)
+            if (i!=*p_slot) sum += p_pin->slots[i];
+
+        p_privs[gpio].freq = (win_len ? sum*1000000000000ULL/win_len : 0);
+        if (p_pin->edge==GPIO_EVENT_BOTH) p_privs[gpio].freq /= 2;
+    }
+    cnt_publish_mask(p_cnt, p_privs, p_cnt->pins);
+}
+
+/* CDEV source counter thread.
+ */
+static void *cnt_cdev_thrd(void *arg)
+{
+    gpio_cnt_t *p_cnt = (gpio_cnt_t*)arg;
+
+    unsigned int slot=0;
+    uint64_t start, slot_end, touched;
+    int timeout = (int)MAX(p_cnt->slot_len/1000000U, 1);
+    cnt_priv_t privs[GPIO_NUM];
+    gpio_event_t evs[GPIO_CNT_BATCH];
+
+    memset(privs, 0, sizeof(privs));
+    start = time_ns();
+    slot_end = start+p_cnt->slot_len;
+
+    while (ATOMIC_LOAD(p_cnt->run))
+    {
+        size_t i, n_evs=0;
+        lr_errc_t ret = gpio_cdev_read_events(
+            p_cnt->p_gpio_h, evs, ARRAY_SZ(evs), &n_evs, timeout);
+
+        if (ret==LREC_SUCCESS)
+        {
+            ATOMIC_STORE(p_cnt->n_reads, p_cnt->n_reads+1);
+
+            for (i=0, touched=0; i<n_evs; i++)
+            {
+                unsigned int gpio = evs[i].gpio;
+                gpio_cnt_pin_t *p_pin;
+                uint32_t n;
+
+                if (gpio>=GPIO_NUM || !(p_cnt->pins & GPIO_MASK(gpio)))
+                    continue;
+                p_pin = &p_cnt->cnts[gpio];
+
+                /* edges lost on the kernel buffer overflow are counted too */
+                n = (p_pin->line_seqno ? evs[i].line_seqno-p_pin->line_seqno : 1);
+                p_pin->line_seqno = evs[i].line_seqno;
+
+                CNT_EDGES(p_cnt, privs, slot, gpio, n, evs[i].ts);
+                touched |= GPIO_MASK(gpio);
+            }
+            cnt_publish_mask(p_cnt, privs, touched);
+        } else
+        if (ret!=LREC_TIMEOUT) {
+            ATOMIC_STORE(p_cnt->n_errs, p_cnt->n_errs+1);
+            usleep(timeout*1000);
+        }
+
+        cnt_slide(p_cnt, privs, time_ns(), start, &slot_end, &slot);
+    }
+    return NULL;
+}
+
+/* BCM source counter thread.
+ */
+static void *cnt_bcm_thrd(void *arg)
+{
+    gpio_cnt_t *p_cnt = (gpio_cnt_t*)arg;
+    gpio_hndl_t *p_gpio_h = p_cnt->p_gpio_h;
+
+    unsigned int slot=0;
+    uint64_t start, slot_end, next, now, eds;
+    struct timespec tp;
+    cnt_priv_t privs[GPIO_NUM];
+
+    memset(privs, 0, sizeof(privs));
+    next = start = time_ns();
+    slot_end = start+p_cnt->slot_len;
+
+    while (ATOMIC_LOAD(p_cnt->run))
+    {
+        next += p_cnt->period;
+        tp.tv_sec = next/1000000000U;
+        tp.tv_nsec = next%1000000000U;
+        /* restart the sleep interrupted by a signal */
+        while (clock_nanosleep(
+            CLOCK_MONOTONIC, TIMER_ABSTIME, &tp, NULL)==EINTR);
+
+        /* missed polls may result in lost edges */
+        now = time_ns();
+        if ((int64_t)(now-next) >= (int64_t)p_cnt->period) {
+            uint64_t n_miss = (now-next)/p_cnt->period;
+            ATOMIC_STORE(p_cnt->n_overruns, p_cnt->n_overruns+n_miss);
+            next += n_miss*p_cnt->period;
+        }
+        ATOMIC_STORE(p_cnt->n_reads, p_cnt->n_reads+1);
+
+        /* read and acknowledge the detected events */
+        eds = 0;
+        gpio_bcm_get_events(p_gpio_h, p_cnt->pins, &eds);
+
+        if (eds)
+        {
+            uint64_t mask;
+
+            for (mask=eds; mask; mask&=mask-1) {
+                unsigned int gpio = __builtin_ctzll(mask);
+                CNT_EDGES(p_cnt, privs, slot, gpio, 1, now);
+            }
+            cnt_publish_mask(p_cnt, privs, eds);
+        }
+
+        cnt_slide(p_cnt, privs, now, start, &slot_end, &slot);
+    }
+    return NULL;
+}
+
+/* Discard events detected before the counting start (e.g. while stopped).
+ */
+static void cnt_drain(gpio_cnt_t *p_cnt)
+{
+    size_t n_evs;
+    uint64_t eds;
+    gpio_event_t evs[GPIO_CNT_BATCH];
+
+    if (p_cnt->src==gpio_cnt_bcm) {
+        gpio_bcm_get_events(p_cnt->p_gpio_h, p_cnt->pins, &eds);
+    } else {
+        while (gpio_cdev_read_events(p_cnt->p_gpio_h,
+            evs, ARRAY_SZ(evs), &n_evs, 0)==LREC_SUCCESS &&
+            n_evs==ARRAY_SZ(evs));
+    }
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_cnt_start(gpio_cnt_t *p_cnt)
+{
+    unsigned int i;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_cnt->run) goto finish;
+
+    cnt_drain(p_cnt);
+
+    for (i=0; i<GPIO_NUM; i++) {
+        gpio_cnt_pin_t *p_pin = &p_cnt->cnts[i];
+
+        /* gpio_cnt_read() may be called concurrently */
+        cnt_publish(p_pin, 0, 0, 0, 0);
+        p_pin->line_seqno = 0;
+        memset(p_pin->slots, 0, sizeof(p_pin->slots));
+    }
+    p_cnt->n_reads = p_cnt->n_overruns = p_cnt->n_errs = 0;
+    ATOMIC_STORE(p_cnt->run, TRUE);
+
+    if ((ret=thrd_create_rt(&p_cnt->thrd,
+        (p_cnt->src==gpio_cnt_bcm ? cnt_bcm_thrd : cnt_cdev_thrd),
+        p_cnt, &p_cnt->rt))!=LREC_SUCCESS)
+    {
+        ATOMIC_STORE(p_cnt->run, FALSE);
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_cnt_stop(gpio_cnt_t *p_cnt)
+{
+    if (p_cnt->run) {
+        ATOMIC_STORE(p_cnt->run, FALSE);
+        pthread_join(p_cnt->thrd, NULL);
+    }
+}
+
+/* exported; see header for details */
+lr_errc_t
+    gpio_cnt_read(gpio_cnt_t *p_cnt, unsigned int gpio, gpio_cnt_stat_t *p_stat)
+{
+    gpio_cnt_pin_t *p_pin;
+    uint32_t seq;
+    uint64_t freq;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+    if (!(p_cnt->pins & GPIO_MASK(gpio))) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    p_pin = &p_cnt->cnts[gpio];
+
+    /* seqlock read; retried if the state was updated in the meantime */
+    do {
+        while ((seq=__atomic_load_n(&p_pin->seq, __ATOMIC_ACQUIRE)) & 1);
+
+        p_stat->count = SEQ_LOAD(p_pin->count);
+        p_stat->first_ts = SEQ_LOAD(p_pin->first_ts);
+        p_stat->last_ts = SEQ_LOAD(p_pin->last_ts);
+        freq = SEQ_LOAD(p_pin->freq);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (SEQ_LOAD(p_pin->seq)!=seq);
+
+    p_stat->freq = freq/1000.;
+finish:
+    return ret;
+}
@@ -0,0 +1,344 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "common.h"
+#include "librasp/gpio_dbnc.h"
+
+/* exported; see header for details */
+lr_errc_t gpio_dbnc_init(gpio_dbnc_t *p_dbnc,
+    gpio_hndl_t *p_gpio_h, uint32_t rate, uint32_t n_evs)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_dbnc, 0, sizeof(*p_dbnc));
+    p_dbnc->evfd = -1;
+
+    if (!rate || rate>1000000000U || !n_evs) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+
+    if (!(p_dbnc->p_evs = (gpio_event_t*)malloc(n_evs*sizeof(gpio_event_t))))
+    {
+        ret=LREC_NOMEM;
+        goto finish;
+    }
+
+    if ((p_dbnc->evfd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC)) == -1) {
+        err_printf("[%s] eventfd() error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_OPEN_ERR;
+        goto finish;
+    }
+
+    p_dbnc->p_gpio_h = p_gpio_h;
+    p_dbnc->period = 1000000000U/rate;
+    p_dbnc->n_evs = n_evs;
+finish:
+    if (ret!=LREC_SUCCESS) gpio_dbnc_free(p_dbnc);
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_dbnc_free(gpio_dbnc_t *p_dbnc)
+{
+    gpio_dbnc_stop(p_dbnc);
+
+    if (p_dbnc->evfd != -1) {
+        close(p_dbnc->evfd);
+        p_dbnc->evfd = -1;
+    }
+    if (p_dbnc->p_evs) {
+        free(p_dbnc->p_evs);
+        p_dbnc->p_evs = NULL;
+    }
+}
+
+/* Put event into the queue.
+ */
+static void push_event(gpio_dbnc_t *p_dbnc, const gpio_event_t *p_ev)
+{
+    uint32_t head = p_dbnc->head;
+
+    if (head-ATOMIC_LOAD(p_dbnc->tail) >= p_dbnc->n_evs) {
+        p_dbnc->stats.n_dropped++;
+    } else {
+        p_dbnc->p_evs[head%p_dbnc->n_evs] = *p_ev;
+        ATOMIC_STORE(p_dbnc->head, head+1);
+        p_dbnc->stats.n_events++;
+    }
+}
+
+/* Debounce engine thread.
+ */
+static void *dbnc_thrd(void *arg)
+{
+    gpio_dbnc_t *p_dbnc = (gpio_dbnc_t*)arg;
+    gpio_dbnc_stats_t *p_stats = &p_dbnc->stats;
+
+    unsigned int gpio;
+    uint8_t ns[GPIO_NUM], cnts[GPIO_NUM];
+    uint32_t seqno=0, line_seqnos[GPIO_NUM];
+    uint64_t pins=0, integ=0, rst=0, out=0, active=0, raw, next, now;
+    gpio_event_t ev;
+    struct timespec tp;
+
+    memset(line_seqnos, 0, sizeof(line_seqnos));
+    memset(&ev, 0, sizeof(ev));
+
+    next = time_ns();
+
+    while (ATOMIC_LOAD(p_dbnc->run))
+    {
+        uint64_t chg, m, emitted=0;
+
+        next += p_dbnc->period;
+        tp.tv_sec = next/1000000000U;
+        tp.tv_nsec = next%1000000000U;
+        /* restart the sleep interrupted by a signal */
+        while (clock_nanosleep(
+            CLOCK_MONOTONIC, TIMER_ABSTIME, &tp, NULL)==EINTR);
+
+        /* skip ticks missed (e.g. due to preemption) */
+        now = time_ns();
+        if ((int64_t)(now-next) >= (int64_t)p_dbnc->period) {
+            uint64_t n_miss = (now-next)/p_dbnc->period;
+            p_stats->n_overruns += n_miss;
+            next += n_miss*p_dbnc->period;
+        }
+        p_stats->n_ticks++;
+
+        /* apply configuration update; filters of updated GPIOs are restarted */
+        if ((m = __atomic_exchange_n(&p_dbnc->upd, 0, __ATOMIC_ACQ_REL)))
+        {
+            pins = ATOMIC_LOAD(p_dbnc->pins);
+            integ = ATOMIC_LOAD(p_dbnc->integ);
+            for (gpio=0; gpio<GPIO_NUM; gpio++)
+                ns[gpio] = ATOMIC_LOAD(p_dbnc->ns[gpio]);
+
+            rst |= m & pins;
+            out &= pins;
+            active &= pins;
+
+            /* levels of removed GPIOs are cleared */
+            ATOMIC_STORE(p_dbnc->levs, out);
+        }
+
+        if (!pins) continue;
+
+        if (gpio_read_bank(p_dbnc->p_gpio_h, pins, &raw)!=LREC_SUCCESS) {
+            p_stats->n_errs++;
+            continue;
+        }
+
+        if (rst) {
+            for (m=rst; m; m&=m-1) {
+                gpio = __builtin_ctzll(m);
+                cnts[gpio] = ((raw>>gpio)&1 && (integ>>gpio)&1 ? ns[gpio] : 0);
+            }
+            out = SET_BITFLD(out, raw&rst, rst);
+            active &= ~rst;
+            rst = 0;
+        }
+
+        /* GPIOs with input differing from the filtered level or not settled
+           filters are processed only */
+        active |= (raw^out) & pins;
+
+        for (m=active; m; m&=m-1)
+        {
+            uint64_t bit;
+
+            gpio = __builtin_ctzll(m);
+            bit = GPIO_MASK(gpio);
+            chg = 0;
+
+            if (integ & bit)
+            {
+                if (raw & bit) {
+                    if (cnts[gpio]<ns[gpio]) cnts[gpio]++;
+                    if (cnts[gpio]>=ns[gpio]) {
+                        chg = ~out & bit;
+                        active &= ~bit;
+                    }
+                } else {
+                    if (cnts[gpio]) cnts[gpio]--;
+                    if (!cnts[gpio]) {
+                        chg = out & bit;
+                        active &= ~bit;
+                    }
+                }
+            } else
+            {
+                if ((raw^out) & bit) {
+                    if (++cnts[gpio]>=ns[gpio]) {
+                        chg = bit;
+                        cnts[gpio] = 0;
+                        active &= ~bit;
+                    }
+                } else {
+                    cnts[gpio] = 0;
+                    active &= ~bit;
+                }
+            }
+
+            if (chg) {
+                out ^= chg;
+
+                ev.ts = now;
+                ev.seqno = ++seqno;
+                ev.line_seqno = ++line_seqnos[gpio];
+                ev.gpio = gpio;
+                ev.event = ((out & bit) ? GPIO_EVENT_RAISING : GPIO_EVENT_FALLING);
+                push_event(p_dbnc, &ev);
+                emitted |= bit;
+            }
+        }
+
+        ATOMIC_STORE(p_dbnc->levs, out);
+        if (emitted) eventfd_write(p_dbnc->evfd, 1);
+    }
+    return NULL;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_dbnc_start(gpio_dbnc_t *p_dbnc)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_dbnc->run) goto finish;
+
+    memset(&p_dbnc->stats, 0, sizeof(p_dbnc->stats));
+    ATOMIC_STORE(p_dbnc->run, TRUE);
+
+    /* restart filters of all GPIOs */
+    __atomic_or_fetch(&p_dbnc->upd, GPIO_MASK_ALL, __ATOMIC_RELEASE);
+
+    if ((ret=thrd_create_rt(
+        &p_dbnc->thrd, dbnc_thrd, p_dbnc, &p_dbnc->rt))!=LREC_SUCCESS)
+    {
+        ATOMIC_STORE(p_dbnc->run, FALSE);
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_dbnc_stop(gpio_dbnc_t *p_dbnc)
+{
+    if (p_dbnc->run) {
+        ATOMIC_STORE(p_dbnc->run, FALSE);
+        pthread_join(p_dbnc->thrd, NULL);
+    }
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_dbnc_add(gpio_dbnc_t *p_dbnc,
+    unsigned int gpio, gpio_dbnc_filter_t filter, unsigned int n)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    if (!n || n>GPIO_DBNC_MAX_N) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+
+    ATOMIC_STORE(p_dbnc->ns[gpio], (uint8_t)n);
+    if (filter==gpio_dbnc_integrator)
+        __atomic_or_fetch(&p_dbnc->integ, GPIO_MASK(gpio), __ATOMIC_RELEASE);
+    else
+        __atomic_and_fetch(&p_dbnc->integ, ~GPIO_MASK(gpio), __ATOMIC_RELEASE);
+    __atomic_or_fetch(&p_dbnc->pins, GPIO_MASK(gpio), __ATOMIC_RELEASE);
+    __atomic_or_fetch(&p_dbnc->upd, GPIO_MASK(gpio), __ATOMIC_RELEASE);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_dbnc_del(gpio_dbnc_t *p_dbnc, unsigned int gpio)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    __atomic_and_fetch(&p_dbnc->pins, ~GPIO_MASK(gpio), __ATOMIC_RELEASE);
+    __atomic_or_fetch(&p_dbnc->upd, GPIO_MASK(gpio), __ATOMIC_RELEASE);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_dbnc_read_events(gpio_dbnc_t *p_dbnc,
+    gpio_event_t *p_evs, size_t n_evs, size_t *p_n_read, int timeout)
+{
+    size_t n_read=0;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    for (;;)
+    {
+        struct pollfd pfd;
+        eventfd_t cnt;
+        uint32_t tail = p_dbnc->tail;
+        uint32_t head = ATOMIC_LOAD(p_dbnc->head);
+
+        for (; n_read<n_evs && tail!=head; n_read++, tail++)
+            p_evs[n_read] = p_dbnc->p_evs[tail%p_dbnc->n_evs];
+        ATOMIC_STORE(p_dbnc->tail, tail);
+
+        /* queue drained; reset the notification and re-check to not lose
+           notification of events put in the meantime */
+        if (tail==head) {
+            eventfd_read(p_dbnc->evfd, &cnt);
+            if (tail!=ATOMIC_LOAD(p_dbnc->head))
+                eventfd_write(p_dbnc->evfd, 1);
+        }
+
+        if (n_read || !timeout) break;
+
+        pfd.fd = p_dbnc->evfd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll(&pfd, 1, timeout) < 0) {
+            if (errno==EINTR) continue;
+            err_printf("[%s] poll() error: %d; %s\n",
+                __func__, errno, strerror(errno));
+            ret=LREC_POLL_ERR;
+            goto finish;
+        }
+        /* check once more after timeout */
+        if (!pfd.revents) timeout=0;
+    }
+
+    if (!n_read) ret=LREC_TIMEOUT;
+finish:
+    *p_n_read = n_read;
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_dbnc_get_stats(gpio_dbnc_t *p_dbnc, gpio_dbnc_stats_t *p_stats)
+{
+    /* statistics are informative only; no consistency guaranteed for
+       a running engine */
+    *p_stats = p_dbnc->stats;
+}
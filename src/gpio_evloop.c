@@ -0,0 +1,254 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#include "common.h"
+#include "librasp/gpio_evloop.h"
+
+/* epoll data marking the CDEV lines request handle */
+#define EVLOOP_CDEV     GPIO_NUM
+
+/* number of CDEV events read at once while dispatching */
+#define EVLOOP_CDEV_EVS 64
+
+/* exported; see header for details */
+lr_errc_t gpio_evloop_init(gpio_evloop_t *p_loop, gpio_hndl_t *p_gpio_h)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_loop, 0, sizeof(*p_loop));
+    p_loop->p_gpio_h = p_gpio_h;
+    p_loop->cdevfd = -1;
+
+    if ((p_loop->epfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+        err_printf("[%s] epoll_create1() error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_POLL_ERR;
+    }
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_evloop_free(gpio_evloop_t *p_loop)
+{
+    if (p_loop->epfd != -1) {
+        close(p_loop->epfd);
+        p_loop->epfd = -1;
+    }
+    p_loop->gpios = p_loop->sysfs = 0;
+    p_loop->cdevfd = -1;
+}
+
+/* Register CDEV lines request handle of the loop's GPIO handle in the epoll
+   set. The lines request may be re-created by the GPIO handle (possibly with
+   the same handle number), therefore the registration is updated if needed.
+ */
+static lr_errc_t cdev_register(gpio_evloop_t *p_loop)
+{
+    struct epoll_event eev;
+    int reqfd = p_loop->p_gpio_h->cdev.reqfd;
+    unsigned int req_id = p_loop->p_gpio_h->cdev.req_id;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_loop->cdevfd!=-1 && p_loop->cdevfd==reqfd &&
+        p_loop->cdev_req_id==req_id) goto finish;
+
+    /* the handle may be already closed; ignore errors */
+    if (p_loop->cdevfd != -1) {
+        epoll_ctl(p_loop->epfd, EPOLL_CTL_DEL, p_loop->cdevfd, NULL);
+        p_loop->cdevfd = -1;
+    }
+
+    if (reqfd == -1) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    memset(&eev, 0, sizeof(eev));
+    eev.events = EPOLLIN;
+    eev.data.u32 = EVLOOP_CDEV;
+    if (epoll_ctl(p_loop->epfd, EPOLL_CTL_ADD, reqfd, &eev) == -1) {
+        err_printf("[%s] epoll_ctl() error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_POLL_ERR;
+        goto finish;
+    }
+    p_loop->cdevfd = reqfd;
+    p_loop->cdev_req_id = req_id;
+finish:
+    return ret;
+}
+
+/* Purge sysfs GPIO value handle from pending data (and event).
+ */
+static int sysfs_read_value(int valfd)
+{
+    char c='0';
+
+    if (pread(valfd, &c, 1, 0)<0) c='0';
+    return c!='0';
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_evloop_add(gpio_evloop_t *p_loop,
+    unsigned int gpio, gpio_evloop_cb_t cb, void *arg)
+{
+    gpio_hndl_t *p_gpio_h = p_loop->p_gpio_h;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    if (p_loop->gpios & GPIO_MASK(gpio)) EXEC_RG(gpio_evloop_del(p_loop, gpio));
+
+    if (p_gpio_h->drv==gpio_drv_sysfs)
+    {
+        struct epoll_event eev;
+        int valfd = p_gpio_h->sysfs.valfds[gpio];
+
+        if (valfd == -1) {
+            ret=LREC_NOINIT;
+            goto finish;
+        }
+        sysfs_read_value(valfd);
+
+        memset(&eev, 0, sizeof(eev));
+        eev.events = EPOLLPRI|EPOLLERR;
+        eev.data.u32 = gpio;
+        if (epoll_ctl(p_loop->epfd, EPOLL_CTL_ADD, valfd, &eev) == -1) {
+            err_printf("[%s] epoll_ctl() error: %d; %s\n",
+                __func__, errno, strerror(errno));
+            ret=LREC_POLL_ERR;
+            goto finish;
+        }
+        p_loop->sysfs |= GPIO_MASK(gpio);
+    } else
+    if (p_gpio_h->drv==gpio_drv_cdev)
+    {
+        if (!(p_gpio_h->cdev.lines & GPIO_MASK(gpio))) {
+            ret=LREC_NOINIT;
+            goto finish;
+        }
+        EXEC_RG(cdev_register(p_loop));
+    } else {
+        ret=LREC_NOT_SUPP;
+        goto finish;
+    }
+
+    p_loop->cbs[gpio].cb = cb;
+    p_loop->cbs[gpio].arg = arg;
+    p_loop->gpios |= GPIO_MASK(gpio);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_evloop_del(gpio_evloop_t *p_loop, unsigned int gpio)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    if (!(p_loop->gpios & GPIO_MASK(gpio))) goto finish;
+
+    if (p_loop->sysfs & GPIO_MASK(gpio)) {
+        epoll_ctl(p_loop->epfd, EPOLL_CTL_DEL,
+            p_loop->p_gpio_h->sysfs.valfds[gpio], NULL);
+        p_loop->sysfs &= ~GPIO_MASK(gpio);
+    }
+    p_loop->gpios &= ~GPIO_MASK(gpio);
+
+    /* no more GPIOs watched via CDEV */
+    if (!(p_loop->gpios & ~p_loop->sysfs) && p_loop->cdevfd != -1) {
+        epoll_ctl(p_loop->epfd, EPOLL_CTL_DEL, p_loop->cdevfd, NULL);
+        p_loop->cdevfd = -1;
+    }
+finish:
+    return ret;
+}
+
+/* Dispatch an event to the GPIO callback.
+ */
+#define DISPATCH_EVENT(p_loop, p_ev) \
+    if ((p_loop)->gpios & GPIO_MASK((p_ev)->gpio)) { \
+        ready |= GPIO_MASK((p_ev)->gpio); \
+        if ((p_loop)->cbs[(p_ev)->gpio].cb) { \
+            (p_loop)->cbs[(p_ev)->gpio].cb((p_loop)->p_gpio_h, \
+                (p_ev), (p_loop)->cbs[(p_ev)->gpio].arg); \
+        } \
+    }
+
+/* exported; see header for details */
+lr_errc_t gpio_evloop_wait(
+    gpio_evloop_t *p_loop, int timeout, uint64_t *p_ready)
+{
+    int i, n;
+    uint64_t ready=0;
+    struct epoll_event eevs[GPIO_NUM+1];
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_loop->gpios & ~p_loop->sysfs) EXEC_RG(cdev_register(p_loop));
+
+    n = epoll_wait(p_loop->epfd, eevs, ARRAY_SZ(eevs), timeout);
+    if (n<0 && errno==EINTR) {
+        /* interrupted by a signal; reported as no events dispatched */
+        n = 0;
+    } else
+    if (n<0) {
+        err_printf("[%s] epoll_wait() error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        ret=LREC_POLL_ERR;
+        goto finish;
+    }
+
+    for (i=0; i<n; i++)
+    {
+        if (eevs[i].data.u32 == EVLOOP_CDEV)
+        {
+            size_t j, n_evs;
+            gpio_event_t evs[EVLOOP_CDEV_EVS];
+
+            do {
+                if (gpio_cdev_read_events(p_loop->p_gpio_h,
+                    evs, ARRAY_SZ(evs), &n_evs, 0)!=LREC_SUCCESS) break;
+
+                for (j=0; j<n_evs; j++) {
+                    DISPATCH_EVENT(p_loop, &evs[j]);
+                }
+            } while (n_evs==ARRAY_SZ(evs));
+        } else
+        {
+            struct timespec tp;
+            gpio_event_t ev;
+
+            memset(&ev, 0, sizeof(ev));
+            clock_gettime(CLOCK_MONOTONIC, &tp);
+
+            ev.ts = (uint64_t)tp.tv_sec*1000000000LL + tp.tv_nsec;
+            ev.gpio = eevs[i].data.u32;
+            ev.event = (sysfs_read_value(
+                p_loop->p_gpio_h->sysfs.valfds[ev.gpio]) ?
+                GPIO_EVENT_RAISING : GPIO_EVENT_FALLING);
+
+            DISPATCH_EVENT(p_loop, &ev);
+        }
+    }
+
+    if (!ready) ret=LREC_TIMEOUT;
+finish:
+    if (p_ready) *p_ready = ready;
+    return ret;
+}
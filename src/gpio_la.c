@@ -0,0 +1,292 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "librasp/gpio_la.h"
+#include "librasp/sim.h"
+
+#define get_stc_ticks(p_la) \
+    ((uint32_t)*IO_REG32_PTR((p_la)->p_clk_h->io.p_stc_io, ST_CLO))
+
+/* exported; see header for details */
+lr_errc_t gpio_la_init(gpio_la_t *p_la,
+    gpio_hndl_t *p_gpio_h, clock_hndl_t *p_clk_h, size_t n_recs)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_la, 0, sizeof(*p_la));
+
+    if (!n_recs) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (!p_gpio_h->io.p_gpio_io || !p_clk_h->io.p_stc_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    if (!(p_la->p_recs = (gpio_la_rec_t*)malloc(n_recs*sizeof(gpio_la_rec_t))))
+    {
+        ret=LREC_NOMEM;
+        goto finish;
+    }
+
+    p_la->p_gpio_h = p_gpio_h;
+    p_la->p_clk_h = p_clk_h;
+    p_la->n_recs = n_recs;
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_la_free(gpio_la_t *p_la)
+{
+    if (p_la->p_recs) {
+        free(p_la->p_recs);
+        p_la->p_recs = NULL;
+    }
+    p_la->n_recs = p_la->count = 0;
+}
+
+/* Add a record to the ring; the caller is responsible to assure free space.
+ */
+#define PUSH_REC(p_la, l, t) { \
+    gpio_la_rec_t *p_rec = \
+        &(p_la)->p_recs[((p_la)->first+(p_la)->count)%(p_la)->n_recs]; \
+    p_rec->levs = (l); \
+    p_rec->tick = (t); \
+    (p_la)->count++; \
+}
+
+#if CONFIG_SIM_DRIVER
+# define LA_SYNC(sim) if (sim) sim_sync();
+#else
+# define LA_SYNC(sim)
+#endif
+
+/* Sampling loop; 'sim' is a constant specializing the loop for the simulator
+   (synchronized before each STC and GPIO levels read). The capture start and
+   end ticks are written under 'p_t0' and 'p_now'.
+ */
+static inline lr_errc_t la_sample(gpio_la_t *p_la, const gpio_la_cfg_t *p_cfg,
+    uint32_t *p_t0, uint32_t *p_now, const bool_t sim)
+{
+    bool_t triggered;
+    uint64_t k=0, rd_mask, mask, levs, prev;
+    uint32_t t0, now, last, trig_t=0, gap;
+    gpio_la_stats_t *p_stats = &p_la->stats;
+    gpio_hndl_t *p_gpio_h = p_la->p_gpio_h;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    mask = p_cfg->mask;
+    rd_mask = mask|p_cfg->trig_mask;
+
+    LA_SYNC(sim);
+    now = last = t0 = get_stc_ticks(p_la);
+    prev = levs = gpio_io_read_bank_fast(p_gpio_h, rd_mask);
+    p_stats->n_samples++;
+
+    triggered = (p_cfg->trig==gpio_la_trig_none ||
+        (p_cfg->trig==gpio_la_trig_level &&
+        !((levs^p_cfg->trig_levs) & p_cfg->trig_mask)));
+
+    if (triggered) {
+        trig_t = now;
+        PUSH_REC(p_la, levs&mask, now);
+    } else
+    if (p_cfg->n_pretrig) {
+        PUSH_REC(p_la, levs&mask, now);
+    }
+
+    for (;;)
+    {
+        if (p_cfg->max_rate)
+        {
+            uint64_t el, exp_k;
+
+            /* wait for the next sample time slot */
+            k++;
+            do {
+                LA_SYNC(sim);
+                now = get_stc_ticks(p_la);
+                el = (uint32_t)(now-t0);
+            } while (el*p_cfg->max_rate < k*1000000U);
+
+            /* late by more than a slot (e.g. preempted) */
+            exp_k = el*p_cfg->max_rate/1000000U;
+            if (exp_k>k) {
+                p_stats->n_dropped += exp_k-k;
+                k = exp_k;
+            }
+        } else {
+            LA_SYNC(sim);
+            now = get_stc_ticks(p_la);
+        }
+
+        levs = gpio_io_read_bank_fast(p_gpio_h, rd_mask);
+        p_stats->n_samples++;
+
+        gap = now-last;
+        last = now;
+        if (gap>p_stats->max_gap) p_stats->max_gap = gap;
+        if (!p_cfg->max_rate && gap>1) p_stats->n_dropped += gap-1;
+
+        if (!triggered)
+        {
+            if ((p_cfg->trig==gpio_la_trig_level &&
+                    !((levs^p_cfg->trig_levs) & p_cfg->trig_mask)) ||
+                (p_cfg->trig==gpio_la_trig_change &&
+                    ((levs^prev) & p_cfg->trig_mask)))
+            {
+                /* trigger record is always added */
+                triggered = TRUE;
+                trig_t = now;
+                PUSH_REC(p_la, levs&mask, now);
+                p_la->trig_rec = p_la->count-1;
+            } else
+            if (p_cfg->trig_timeout && now-t0>=p_cfg->trig_timeout) {
+                ret=LREC_TIMEOUT;
+                break;
+            } else
+            if (((levs^prev) & mask) && p_cfg->n_pretrig) {
+                /* overwrite the oldest pre-trigger record */
+                if (p_la->count>=p_cfg->n_pretrig) {
+                    p_la->first = (p_la->first+1)%p_la->n_recs;
+                    p_la->count--;
+                }
+                PUSH_REC(p_la, levs&mask, now);
+            }
+        } else
+        {
+            if ((levs^prev) & mask) {
+                if (p_la->count>=p_la->n_recs) {
+                    p_stats->overflow = TRUE;
+                    break;
+                }
+                PUSH_REC(p_la, levs&mask, now);
+            }
+            if (now-trig_t>=p_cfg->duration) break;
+        }
+        prev = levs;
+    }
+
+    *p_t0 = t0;
+    *p_now = now;
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_la_capture(gpio_la_t *p_la, const gpio_la_cfg_t *p_cfg)
+{
+    sched_rt_t sched_h;
+    uint32_t t0, now;
+    gpio_la_stats_t *p_stats = &p_la->stats;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_MASK(p_cfg->mask|p_cfg->trig_mask);
+
+    if (!p_la->p_recs) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    if (p_cfg->n_pretrig>=p_la->n_recs) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+
+    p_la->cfg = *p_cfg;
+    p_la->first = p_la->count = p_la->trig_rec = 0;
+    memset(p_stats, 0, sizeof(*p_stats));
+
+    /* Enter timing critical part
+     */
+    sched_rt_raise_max(&sched_h);
+
+#if CONFIG_SIM_DRIVER
+    if (p_la->p_gpio_h->io.sim || p_la->p_clk_h->io.sim) {
+        ret = la_sample(p_la, p_cfg, &t0, &now, TRUE);
+    } else
+#endif
+    ret = la_sample(p_la, p_cfg, &t0, &now, FALSE);
+
+    /* Exit timing critical part
+     */
+    sched_restore(&sched_h);
+
+    p_la->end_tick = now;
+    p_stats->elapsed = now-t0;
+    if (p_stats->elapsed) {
+        p_stats->rate = (uint32_t)(p_stats->n_samples*1000000U/p_stats->elapsed);
+    }
+
+finish:
+    return ret;
+}
+
+/* VCD identifier of a GPIO signal */
+#define VCD_ID(gpio) ((char)('!'+(gpio)))
+
+/* exported; see header for details */
+lr_errc_t gpio_la_export_vcd(const gpio_la_t *p_la, FILE *f)
+{
+    size_t i;
+    unsigned int gpio;
+    uint64_t mask = p_la->cfg.mask, levs=0;
+    const gpio_la_rec_t *p_rec, *p_first;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!(p_first = gpio_la_get_rec(p_la, 0))) {
+        ret=LREC_EMPTY;
+        goto finish;
+    }
+
+    fprintf(f, "$comment librasp GPIO capture; sample rate: %u Hz, "
+        "dropped samples: %llu%s $end\n", p_la->stats.rate,
+        (unsigned long long)p_la->stats.n_dropped,
+        (p_la->stats.overflow ? ", overflow" : ""));
+    if (p_la->cfg.trig!=gpio_la_trig_none) {
+        p_rec = gpio_la_get_rec(p_la, p_la->trig_rec);
+        fprintf(f, "$comment trigger at #%u $end\n",
+            (unsigned int)(p_rec->tick-p_first->tick));
+    }
+    fprintf(f, "$timescale 1us $end\n$scope module gpio $end\n");
+    for (gpio=0; gpio<GPIO_NUM; gpio++) {
+        if (mask & GPIO_MASK(gpio))
+            fprintf(f, "$var wire 1 %c GPIO%u $end\n", VCD_ID(gpio), gpio);
+    }
+    fprintf(f, "$upscope $end\n$enddefinitions $end\n");
+
+    for (i=0; (p_rec = gpio_la_get_rec(p_la, i)); i++)
+    {
+        uint64_t chg = (i ? (p_rec->levs^levs) & mask : mask);
+
+        if (!chg) continue;
+
+        fprintf(f, "#%u\n", (unsigned int)(p_rec->tick-p_first->tick));
+        if (!i) fprintf(f, "$dumpvars\n");
+        for (gpio=0; (chg>>gpio); gpio++) {
+            if ((chg>>gpio)&1)
+                fprintf(f, "%u%c\n", GPIO_LEV(p_rec->levs, gpio), VCD_ID(gpio));
+        }
+        if (!i) fprintf(f, "$end\n");
+        levs = p_rec->levs;
+    }
+
+    /* capture end time */
+    fprintf(f, "#%u\n", (unsigned int)(p_la->end_tick-p_first->tick));
+
+    if (ferror(f)) ret=LREC_WRITE_ERR;
+finish:
+    return ret;
+}
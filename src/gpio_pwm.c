@@ -0,0 +1,295 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "librasp/gpio_pwm.h"
+#include "librasp/sim.h"
+
+/* edge wait time [us] above which the engine thread sleeps */
+#define PWM_SLEEP_THRSHD    200U
+
+#define get_stc_ticks(p_pwm) \
+    ((uint32_t)*IO_REG32_PTR((p_pwm)->p_clk_h->io.p_stc_io, ST_CLO))
+
+#if CONFIG_SIM_DRIVER
+# define PWM_SYNC(sim) if (sim) sim_sync();
+#else
+# define PWM_SYNC(sim)
+#endif
+
+/* exported; see header for details */
+lr_errc_t gpio_pwm_init(gpio_pwm_t *p_pwm,
+    gpio_hndl_t *p_gpio_h, clock_hndl_t *p_clk_h, uint32_t period)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_pwm, 0, sizeof(*p_pwm));
+
+    if (period<GPIO_PWM_MIN_PERIOD) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (!p_gpio_h->io.p_gpio_io || !p_clk_h->io.p_stc_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    p_pwm->p_gpio_h = p_gpio_h;
+    p_pwm->p_clk_h = p_clk_h;
+    p_pwm->period = period;
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_pwm_free(gpio_pwm_t *p_pwm)
+{
+    gpio_pwm_stop(p_pwm);
+}
+
+/* exported; see header for details */
+void gpio_pwm_build_sched(gpio_pwm_sched_t *p_sched,
+    uint32_t period, uint64_t chans, const uint32_t *p_duties)
+{
+    unsigned int gpio, i;
+
+    memset(p_sched, 0, sizeof(*p_sched));
+    p_sched->period = period;
+
+    /* period start edge is always present */
+    p_sched->n_edges = 1;
+
+    for (gpio=0; (chans>>gpio); gpio++)
+    {
+        uint32_t off;
+        uint64_t gpio_msk = GPIO_MASK(gpio);
+
+        if (!(chans & gpio_msk)) continue;
+
+        off = (uint32_t)((uint64_t)period *
+            MIN(p_duties[gpio], GPIO_PWM_DUTY_RES) / GPIO_PWM_DUTY_RES);
+
+        if (!off) {
+            p_sched->edges[0].clr |= gpio_msk;
+            continue;
+        }
+        p_sched->edges[0].set |= gpio_msk;
+        if (off>=period) continue;
+
+        /* insert clear edge in the tick order */
+        for (i=1; i<p_sched->n_edges && p_sched->edges[i].tick<off; i++);
+
+        if (i>=p_sched->n_edges || p_sched->edges[i].tick!=off) {
+            memmove(&p_sched->edges[i+1], &p_sched->edges[i],
+                (p_sched->n_edges-i)*sizeof(p_sched->edges[0]));
+            p_sched->n_edges++;
+            p_sched->edges[i].tick = off;
+            p_sched->edges[i].set = 0;
+            p_sched->edges[i].clr = 0;
+        }
+        p_sched->edges[i].clr |= gpio_msk;
+    }
+}
+
+/* Wait for STC 'tick'; sleep if there is enough time.
+ */
+static inline uint32_t wait_tick(
+    gpio_pwm_t *p_pwm, uint32_t tick, const bool_t sim)
+{
+    int32_t delta;
+    uint32_t now;
+
+    for (;;) {
+        PWM_SYNC(sim);
+        now = get_stc_ticks(p_pwm);
+        if ((delta = (int32_t)(tick-now)) <= 0) break;
+        if ((uint32_t)delta > PWM_SLEEP_THRSHD)
+            usleep((uint32_t)delta-PWM_SLEEP_THRSHD);
+    }
+    return now;
+}
+
+/* PWM engine; 'sim' is a constant specializing the engine for the simulator
+   (synchronized after each edge write and before each STC read).
+ */
+static inline void pwm_exec(gpio_pwm_t *p_pwm, const bool_t sim)
+{
+    gpio_pwm_sched_t *p_sched = &p_pwm->sched;
+    gpio_pwm_stats_t *p_stats = &p_pwm->stats;
+
+    unsigned int i, gpio;
+    bool_t built=FALSE;
+    uint32_t gen=0, t0, start, now, delay, duties[GPIO_NUM];
+    uint64_t chans=0, all_chans=0, cpu;
+    struct timespec tp;
+
+    PWM_SYNC(sim);
+    start = t0 = get_stc_ticks(p_pwm)+1;
+
+    while (ATOMIC_LOAD(p_pwm->run))
+    {
+        /* apply configuration update */
+        if (!built || ATOMIC_LOAD(p_pwm->cfg_gen)!=gen)
+        {
+            uint64_t prev_chans = chans;
+
+            gen = ATOMIC_LOAD(p_pwm->cfg_gen);
+            chans = ATOMIC_LOAD(p_pwm->chans);
+            for (gpio=0; gpio<GPIO_NUM; gpio++)
+                duties[gpio] = ATOMIC_LOAD(p_pwm->duties[gpio]);
+
+            gpio_pwm_build_sched(
+                p_sched, ATOMIC_LOAD(p_pwm->period), chans, duties);
+            /* removed channels are left low */
+            p_sched->edges[0].clr |= prev_chans & ~chans;
+            all_chans |= chans;
+            built = TRUE;
+        }
+
+        for (i=0; i<p_sched->n_edges; i++)
+        {
+            const gpio_pwm_edge_t *p_edge = &p_sched->edges[i];
+            uint32_t tick = start+p_edge->tick;
+
+            wait_tick(p_pwm, tick, sim);
+            gpio_io_set_mask_fast(p_pwm->p_gpio_h, p_edge->set);
+            gpio_io_clr_mask_fast(p_pwm->p_gpio_h, p_edge->clr);
+            PWM_SYNC(sim);
+
+            delay = get_stc_ticks(p_pwm)-tick;
+            if (delay>p_stats->max_jitter) p_stats->max_jitter = delay;
+            p_stats->sum_jitter += delay;
+            p_stats->n_edges++;
+        }
+        p_stats->n_periods++;
+
+        /* skip periods missed (e.g. due to preemption) */
+        start += p_sched->period;
+        PWM_SYNC(sim);
+        now = get_stc_ticks(p_pwm);
+        if ((int32_t)(now-start) >= (int32_t)p_sched->period) {
+            uint32_t n_miss = (now-start)/p_sched->period;
+            p_stats->n_overruns += n_miss;
+            start += n_miss*p_sched->period;
+        }
+    }
+
+    gpio_io_clr_mask_fast(p_pwm->p_gpio_h, all_chans);
+    PWM_SYNC(sim);
+
+    if (!clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tp)) {
+        cpu = (uint64_t)tp.tv_sec*1000000U + tp.tv_nsec/1000;
+        now = get_stc_ticks(p_pwm)-t0;
+        if (now) p_stats->cpu_load = (uint32_t)(cpu*1000/now);
+    }
+}
+
+/* PWM engine thread.
+ */
+static void *pwm_thrd(void *arg)
+{
+    gpio_pwm_t *p_pwm = (gpio_pwm_t*)arg;
+
+#if CONFIG_SIM_DRIVER
+    if (p_pwm->p_gpio_h->io.sim || p_pwm->p_clk_h->io.sim) {
+        pwm_exec(p_pwm, TRUE);
+    } else
+#endif
+    pwm_exec(p_pwm, FALSE);
+    return NULL;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_pwm_start(gpio_pwm_t *p_pwm)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_pwm->run) goto finish;
+
+    memset(&p_pwm->stats, 0, sizeof(p_pwm->stats));
+    ATOMIC_STORE(p_pwm->run, TRUE);
+
+    if ((ret=thrd_create_rt(
+        &p_pwm->thrd, pwm_thrd, p_pwm, &p_pwm->rt))!=LREC_SUCCESS)
+    {
+        ATOMIC_STORE(p_pwm->run, FALSE);
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_pwm_stop(gpio_pwm_t *p_pwm)
+{
+    if (p_pwm->run) {
+        ATOMIC_STORE(p_pwm->run, FALSE);
+        pthread_join(p_pwm->thrd, NULL);
+    }
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_pwm_set_period(gpio_pwm_t *p_pwm, uint32_t period)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (period<GPIO_PWM_MIN_PERIOD) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    ATOMIC_STORE(p_pwm->period, period);
+    __atomic_add_fetch(&p_pwm->cfg_gen, 1, __ATOMIC_RELEASE);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_pwm_set_duty(gpio_pwm_t *p_pwm, unsigned int gpio, uint32_t duty)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    if (duty>GPIO_PWM_DUTY_RES) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    ATOMIC_STORE(p_pwm->duties[gpio], duty);
+    __atomic_or_fetch(&p_pwm->chans, GPIO_MASK(gpio), __ATOMIC_RELEASE);
+    __atomic_add_fetch(&p_pwm->cfg_gen, 1, __ATOMIC_RELEASE);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_pwm_del_chan(gpio_pwm_t *p_pwm, unsigned int gpio)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    CHK_GPIO_NUM(gpio);
+
+    __atomic_and_fetch(&p_pwm->chans, ~GPIO_MASK(gpio), __ATOMIC_RELEASE);
+    __atomic_add_fetch(&p_pwm->cfg_gen, 1, __ATOMIC_RELEASE);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_pwm_get_stats(gpio_pwm_t *p_pwm, gpio_pwm_stats_t *p_stats)
+{
+    /* statistics are informative only; no consistency guaranteed for
+       a running engine */
+    *p_stats = p_pwm->stats;
+}
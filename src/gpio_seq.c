@@ -0,0 +1,381 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "librasp/gpio_seq.h"
+#include "librasp/sim.h"
+
+/* max samples number of a sequence (the samples buffer size must fit size_t) */
+#define SAMPLES_MAX (SIZE_MAX/sizeof(uint64_t))
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_init(gpio_seq_t *p_seq, size_t max_ops)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_seq, 0, sizeof(*p_seq));
+
+    /* at least one op and the terminating one */
+    if (max_ops<2) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (!(p_seq->p_ops = (gpio_seq_op_t*)malloc(max_ops*sizeof(gpio_seq_op_t))))
+    {
+        ret=LREC_NOMEM;
+        goto finish;
+    }
+    p_seq->max_ops = max_ops;
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_seq_free(gpio_seq_t *p_seq)
+{
+    if (p_seq->p_ops) {
+        free(p_seq->p_ops);
+        p_seq->p_ops = NULL;
+    }
+    p_seq->max_ops = p_seq->n_ops = 0;
+}
+
+/* Append an op to the sequence.
+ */
+static lr_errc_t seq_add(gpio_seq_t *p_seq,
+    gpio_seq_opc_t opc, uint32_t arg, uint64_t mask, uint64_t levs)
+{
+    gpio_seq_op_t *p_op;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if ((ret=p_seq->err)!=LREC_SUCCESS) goto finish;
+
+    if (!p_seq->p_ops || p_seq->compiled) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    CHK_GPIO_MASK(mask|levs);
+
+    /* keep space for the terminating op */
+    if (p_seq->n_ops+1 >= p_seq->max_ops) {
+        ret=LREC_NO_SPACE;
+        goto finish;
+    }
+
+    p_op = &p_seq->p_ops[p_seq->n_ops++];
+    memset(p_op, 0, sizeof(*p_op));
+    p_op->opc = opc;
+    p_op->arg = arg;
+    p_op->mask = mask;
+    p_op->levs = levs&mask;
+finish:
+    p_seq->err = ret;
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_set(gpio_seq_t *p_seq, uint64_t mask)
+{
+    return seq_add(p_seq, gpio_seq_op_set, 0, mask, 0);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_clr(gpio_seq_t *p_seq, uint64_t mask)
+{
+    return seq_add(p_seq, gpio_seq_op_clr, 0, mask, 0);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_write(gpio_seq_t *p_seq, uint64_t mask, uint64_t levs)
+{
+    return seq_add(p_seq, gpio_seq_op_write, 0, mask, levs);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_wait(gpio_seq_t *p_seq, uint32_t ticks)
+{
+    return seq_add(p_seq, gpio_seq_op_wait, ticks, 0, 0);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_delay(gpio_seq_t *p_seq, uint32_t cycles)
+{
+    return seq_add(p_seq, gpio_seq_op_delay, cycles, 0, 0);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_sample(gpio_seq_t *p_seq, uint64_t mask)
+{
+    return seq_add(p_seq, gpio_seq_op_sample, 0, mask, 0);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_stamp(gpio_seq_t *p_seq)
+{
+    return seq_add(p_seq, gpio_seq_op_stamp, 0, 0, 0);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_wait_lev(
+    gpio_seq_t *p_seq, uint64_t mask, uint64_t levs, uint32_t timeout)
+{
+    return seq_add(p_seq, gpio_seq_op_wait_lev, timeout, mask, levs);
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_loop(gpio_seq_t *p_seq, uint32_t n)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!n || p_seq->depth>=GPIO_SEQ_LOOP_DEPTH) {
+        if (p_seq->err==LREC_SUCCESS) p_seq->err=LREC_INV_ARG;
+        ret=p_seq->err;
+        goto finish;
+    }
+    EXEC_RG(seq_add(p_seq, gpio_seq_op_loop, n, 0, 0));
+
+    p_seq->p_ops[p_seq->n_ops-1].lvl = p_seq->depth;
+    p_seq->loops[p_seq->depth++] = p_seq->n_ops-1;
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_endloop(gpio_seq_t *p_seq)
+{
+    gpio_seq_op_t *p_op;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!p_seq->depth) {
+        if (p_seq->err==LREC_SUCCESS) p_seq->err=LREC_INV_ARG;
+        ret=p_seq->err;
+        goto finish;
+    }
+    EXEC_RG(seq_add(p_seq, gpio_seq_op_endloop, 0, 0, 0));
+
+    p_op = &p_seq->p_ops[p_seq->n_ops-1];
+    p_op->lvl = --p_seq->depth;
+    p_op->jmp = (uint32_t)(p_seq->loops[p_seq->depth]+1);
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_compile(gpio_seq_t *p_seq, size_t *p_n_samples)
+{
+    size_t i, mult[GPIO_SEQ_LOOP_DEPTH+1];
+    unsigned int lvl=0;
+    gpio_seq_op_t *p_op;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (p_seq->compiled) goto finish;
+
+    if ((ret=p_seq->err)!=LREC_SUCCESS) goto finish;
+    if (!p_seq->p_ops) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    if (p_seq->depth) {
+        /* not closed loop */
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+
+    p_op = &p_seq->p_ops[p_seq->n_ops];
+    memset(p_op, 0, sizeof(*p_op));
+    p_op->opc = gpio_seq_op_end;
+
+    /* samples/stamps stored by the sequence (loops unrolled) */
+    p_seq->n_samples = 0;
+    for (i=0, mult[0]=1; i<p_seq->n_ops; i++)
+    {
+        p_op = &p_seq->p_ops[i];
+
+        if (p_op->opc==gpio_seq_op_loop) {
+            /* saturated; fails only if the loop body stores samples */
+            if (__builtin_mul_overflow(mult[lvl], p_op->arg, &mult[lvl+1]))
+                mult[lvl+1] = SIZE_MAX;
+            lvl++;
+        } else
+        if (p_op->opc==gpio_seq_op_endloop) {
+            lvl--;
+        } else
+        if (p_op->opc==gpio_seq_op_sample || p_op->opc==gpio_seq_op_stamp) {
+            /* samples buffer size must be addressable */
+            if (mult[lvl] > SAMPLES_MAX-p_seq->n_samples) {
+                p_seq->n_samples = 0;
+                ret=LREC_INV_ARG;
+                goto finish;
+            }
+            p_seq->n_samples += mult[lvl];
+        }
+    }
+    p_seq->compiled = TRUE;
+finish:
+    if (ret==LREC_SUCCESS && p_n_samples) *p_n_samples = p_seq->n_samples;
+    return ret;
+}
+
+#define SEQ_STC(p_clk_h) (*IO_REG32_PTR((p_clk_h)->io.p_stc_io, ST_CLO))
+
+#if CONFIG_SIM_DRIVER
+# define SEQ_SYNC(sim) if (sim) sim_sync();
+#else
+# define SEQ_SYNC(sim)
+#endif
+
+/* Sequence executor; 'sim' is a constant specializing the loop for
+   the simulator (synchronized after each write and before each read).
+ */
+static inline lr_errc_t seq_exec(const gpio_seq_op_t *p_ops,
+    gpio_hndl_t *p_gpio_h, clock_hndl_t *p_clk_h, uint64_t *p_samples,
+    gpio_seq_report_t *p_rep, const bool_t sim)
+{
+    const gpio_seq_op_t *p_op;
+    uint32_t cnts[GPIO_SEQ_LOOP_DEPTH];
+    uint32_t start, dl, now, t0;
+    uint64_t n_ops=0, *p_smpl=p_samples;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    SEQ_SYNC(sim);
+    dl = start = SEQ_STC(p_clk_h);
+
+    for (p_op=p_ops;; p_op++, n_ops++)
+    {
+        switch (p_op->opc)
+        {
+        case gpio_seq_op_set:
+            gpio_io_set_mask_fast(p_gpio_h, p_op->mask);
+            SEQ_SYNC(sim);
+            break;
+
+        case gpio_seq_op_clr:
+            gpio_io_clr_mask_fast(p_gpio_h, p_op->mask);
+            SEQ_SYNC(sim);
+            break;
+
+        case gpio_seq_op_write:
+            gpio_io_write_bank_fast(p_gpio_h, p_op->mask, p_op->levs);
+            SEQ_SYNC(sim);
+            break;
+
+        case gpio_seq_op_wait:
+            dl += p_op->arg;
+            SEQ_SYNC(sim);
+            now = SEQ_STC(p_clk_h);
+            if ((int32_t)(now-dl) > 0) {
+                p_rep->n_late++;
+                p_rep->max_late = MAX(p_rep->max_late, now-dl);
+            } else {
+                while ((int32_t)(now-dl) < 0) {
+                    SEQ_SYNC(sim);
+                    now = SEQ_STC(p_clk_h);
+                }
+            }
+            break;
+
+        case gpio_seq_op_delay:
+            WAIT_CYCLES(p_op->arg);
+            break;
+
+        case gpio_seq_op_sample:
+            SEQ_SYNC(sim);
+            *p_smpl++ = gpio_io_read_bank_fast(p_gpio_h, p_op->mask);
+            break;
+
+        case gpio_seq_op_stamp:
+            SEQ_SYNC(sim);
+            *p_smpl++ = (uint32_t)(SEQ_STC(p_clk_h)-start);
+            break;
+
+        case gpio_seq_op_wait_lev:
+            SEQ_SYNC(sim);
+            for (t0=SEQ_STC(p_clk_h);;)
+            {
+                now = SEQ_STC(p_clk_h);
+                if (gpio_io_read_bank_fast(p_gpio_h, p_op->mask)==p_op->levs)
+                    break;
+                if (now-t0 >= p_op->arg) {
+                    p_rep->fail_op = (int)(p_op-p_ops);
+                    ret=LREC_TIMEOUT;
+                    goto finish;
+                }
+                SEQ_SYNC(sim);
+            }
+            /* re-synchronize the time line */
+            dl = now;
+            break;
+
+        case gpio_seq_op_loop:
+            cnts[p_op->lvl] = p_op->arg;
+            break;
+
+        case gpio_seq_op_endloop:
+            if (--cnts[p_op->lvl]) p_op = &p_ops[p_op->jmp-1];
+            break;
+
+        default:
+            goto finish;
+        }
+    }
+finish:
+    SEQ_SYNC(sim);
+    p_rep->start = start;
+    p_rep->elapsed = SEQ_STC(p_clk_h)-start;
+    p_rep->n_ops = n_ops;
+    p_rep->n_samples = (size_t)(p_smpl-p_samples);
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_seq_run(const gpio_seq_t *p_seq, gpio_hndl_t *p_gpio_h,
+    clock_hndl_t *p_clk_h, uint64_t *p_samples, size_t n_samples,
+    gpio_seq_report_t *p_rep)
+{
+    sched_rt_t sched_h;
+    gpio_seq_report_t rep;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(&rep, 0, sizeof(rep));
+    rep.fail_op = -1;
+
+    if (!p_seq->compiled || !p_gpio_h->io.p_gpio_io || !p_clk_h->io.p_stc_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    if (n_samples < p_seq->n_samples || (p_seq->n_samples && !p_samples)) {
+        ret=LREC_NO_SPACE;
+        goto finish;
+    }
+
+    /* Enter timing critical part
+     */
+    sched_rt_raise_max(&sched_h);
+
+#if CONFIG_SIM_DRIVER
+    if (p_gpio_h->io.sim || p_clk_h->io.sim) {
+        ret = seq_exec(p_seq->p_ops, p_gpio_h, p_clk_h, p_samples, &rep, TRUE);
+    } else
+#endif
+    ret = seq_exec(p_seq->p_ops, p_gpio_h, p_clk_h, p_samples, &rep, FALSE);
+
+    /* Exit timing critical part
+     */
+    sched_restore(&sched_h);
+finish:
+    if (p_rep) *p_rep = rep;
+    return ret;
+}
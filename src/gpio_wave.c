@@ -0,0 +1,614 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include "common.h"
+#include "librasp/gpio_wave.h"
+#include "librasp/sim.h"
+
+#define REG32(b, r) (*IO_REG32_PTR((b), (r)))
+
+/* peripherals bus addresses */
+#define GPIO_BUS        (BCM_PERI_BUS_BASE+GPIO_BASE_RA)
+#define PWM_FIFO_BUS    (BCM_PERI_BUS_BASE+PWM_BASE_RA+PWM_FIF1)
+#define PCM_FIFO_BUS    (BCM_PERI_BUS_BASE+I2S_BASE_RA+PCM_FIFO_A)
+
+/* memory bus address to physical one */
+#define BUS_TO_PHYS(a)  ((a) & ~0xc0000000U)
+
+/* fake bus address of the memory block used with the SIM driver */
+#define SIM_MEM_BUS     0xc0000000U
+
+/* control blocks per step: pace, set, clear */
+#define STEP_CBS        3
+
+/* DMA memory size per step and max steps number of a waveform (the memory
+   block, rounded up to pages, must fit 32-bit bus addresses space) */
+#define STEP_MEM_SZ     (STEP_CBS*sizeof(dma_cb_t)+sizeof(gpio_wave_step_t))
+#define STEPS_MAX       ((UINT32_MAX-PAGE_SZ-sizeof(uint32_t))/STEP_MEM_SZ)
+
+/* number of writes prefilling the pacing FIFO */
+#define FIFO_PREFILL    64
+
+/* VideoCore mailbox interface */
+#define MBOX_DEV            "/dev/vcio"
+#define MBOX_IOC_PROPERTY   _IOWR(100, 0, char*)
+
+#define MBOX_TAG_MEM_ALLOC      0x3000c
+#define MBOX_TAG_MEM_LOCK       0x3000d
+#define MBOX_TAG_MEM_UNLOCK     0x3000e
+#define MBOX_TAG_MEM_RELEASE    0x3000f
+
+/* direct (uncached) memory allocation flags */
+#define MBOX_MEM_FLAGS          0x04
+#define MBOX_MEM_FLAGS_BCM2708  0x0c
+
+/* Mailbox property call with up to 3 arguments; the 1st response value (0 on
+   error) is returned.
+ */
+static uint32_t mbox_prop(int fd, uint32_t tag,
+    unsigned int n_args, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+    unsigned int i=0;
+    uint32_t buf[16] __attribute__((aligned(16)));
+
+    buf[i++] = 0;               /* size (set below) */
+    buf[i++] = 0;               /* process request */
+    buf[i++] = tag;
+    buf[i++] = 3*sizeof(uint32_t);  /* value buffer size */
+    buf[i++] = n_args*sizeof(uint32_t);
+    buf[i++] = a0;
+    buf[i++] = a1;
+    buf[i++] = a2;
+    buf[i++] = 0;               /* end tag */
+    buf[0] = i*sizeof(uint32_t);
+
+    if (ioctl(fd, MBOX_IOC_PROPERTY, buf) < 0) {
+        err_printf("[%s] ioctl() error: %d; %s\n",
+            __func__, errno, strerror(errno));
+        return 0;
+    }
+    return buf[5];
+}
+
+/* Allocate locked DMA memory block of 'size' bytes via the mailbox.
+ */
+static lr_errc_t mbox_mem_alloc(int fd, gpio_wave_mem_t *p_mem, size_t size)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_mem, 0, sizeof(*p_mem));
+    size = (size+PAGE_SZ-1) & ~(size_t)(PAGE_SZ-1);
+
+    if (!(p_mem->mb_hndl = mbox_prop(fd, MBOX_TAG_MEM_ALLOC, 3, (uint32_t)size,
+        PAGE_SZ, (platform_detect()==bcm_2708 ?
+            MBOX_MEM_FLAGS_BCM2708 : MBOX_MEM_FLAGS))))
+    {
+        err_printf("[%s] Mailbox memory allocation error\n", __func__);
+        ret=LREC_NOMEM;
+        goto finish;
+    }
+    if (!(p_mem->bus = mbox_prop(fd, MBOX_TAG_MEM_LOCK, 1, p_mem->mb_hndl, 0, 0)))
+    {
+        err_printf("[%s] Mailbox memory lock error\n", __func__);
+        ret=LREC_NOMEM;
+        goto finish;
+    }
+    if (!(p_mem->p_virt = io_mmap("/dev/mem", BUS_TO_PHYS(p_mem->bus), size))) {
+        ret=LREC_MMAP_ERR;
+        goto finish;
+    }
+    p_mem->size = size;
+finish:
+    if (ret!=LREC_SUCCESS && p_mem->mb_hndl) {
+        if (p_mem->bus) mbox_prop(fd, MBOX_TAG_MEM_UNLOCK, 1, p_mem->mb_hndl, 0, 0);
+        mbox_prop(fd, MBOX_TAG_MEM_RELEASE, 1, p_mem->mb_hndl, 0, 0);
+        memset(p_mem, 0, sizeof(*p_mem));
+    }
+    return ret;
+}
+
+/* Free mailbox allocated DMA memory block.
+ */
+static void mbox_mem_free(int fd, gpio_wave_mem_t *p_mem)
+{
+    if (p_mem->mb_hndl) {
+        munmap((void*)p_mem->p_virt, p_mem->size);
+        mbox_prop(fd, MBOX_TAG_MEM_UNLOCK, 1, p_mem->mb_hndl, 0, 0);
+        mbox_prop(fd, MBOX_TAG_MEM_RELEASE, 1, p_mem->mb_hndl, 0, 0);
+        memset(p_mem, 0, sizeof(*p_mem));
+    }
+}
+
+/* exported; see header for details */
+size_t gpio_wave_mem_size(size_t n_steps)
+{
+    return (n_steps<=STEPS_MAX ? n_steps*STEP_MEM_SZ+sizeof(uint32_t) : 0);
+}
+
+static void cb_set(volatile dma_cb_t *p_cb,
+    uint32_t ti, uint32_t src, uint32_t dst, uint32_t next)
+{
+    p_cb->ti = ti;
+    p_cb->src = src;
+    p_cb->dst = dst;
+    p_cb->len = sizeof(uint32_t);
+    p_cb->stride = 0;
+    p_cb->next = next;
+    p_cb->rsvd[0] = p_cb->rsvd[1] = 0;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_wave_build(const gpio_wave_mem_t *p_mem,
+    const gpio_wave_step_t *p_steps, size_t n_steps, gpio_wave_pace_t pace,
+    bool_t loop)
+{
+    size_t i;
+    uint32_t ti, pace_ti, data_bus, pace_bus, cb_bus;
+    volatile dma_cb_t *p_cbs = (volatile dma_cb_t*)p_mem->p_virt;
+    volatile uint32_t *p_data;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!n_steps || n_steps>STEPS_MAX ||
+        (pace!=gpio_wave_pace_pwm && pace!=gpio_wave_pace_pcm) ||
+        (p_mem->bus & (sizeof(dma_cb_t)-1)))
+    {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (p_mem->size < gpio_wave_mem_size(n_steps)) {
+        ret=LREC_NO_SPACE;
+        goto finish;
+    }
+
+    /* control blocks are followed by the steps masks and the pacing word */
+    data_bus = p_mem->bus + n_steps*STEP_CBS*sizeof(dma_cb_t);
+    pace_bus = data_bus + n_steps*sizeof(gpio_wave_step_t);
+    p_data = (volatile uint32_t*)&p_cbs[n_steps*STEP_CBS];
+    p_data[2*n_steps] = 0;
+
+    ti = DMA_TI_NO_WIDE_BURSTS|DMA_TI_WAIT_RESP;
+    pace_ti = ti|DMA_TI_DEST_DREQ|DMA_TI_PERMAP(
+        pace==gpio_wave_pace_pwm ? DMA_DREQ_PWM : DMA_DREQ_PCM_TX);
+
+    for (i=0; i<n_steps; i++)
+    {
+        volatile dma_cb_t *p_cb = &p_cbs[i*STEP_CBS];
+
+        p_data[2*i] = p_steps[i].set;
+        p_data[2*i+1] = p_steps[i].clr;
+
+        cb_bus = p_mem->bus + i*STEP_CBS*sizeof(dma_cb_t);
+
+        /* the step starts on the pacing FIFO write acceptance */
+        cb_set(&p_cb[0], pace_ti, pace_bus,
+            (pace==gpio_wave_pace_pwm ? PWM_FIFO_BUS : PCM_FIFO_BUS),
+            cb_bus+sizeof(dma_cb_t));
+        cb_set(&p_cb[1], ti, data_bus+i*sizeof(gpio_wave_step_t),
+            GPIO_BUS+GPSET0, cb_bus+2*sizeof(dma_cb_t));
+        cb_set(&p_cb[2], ti, data_bus+i*sizeof(gpio_wave_step_t)+sizeof(uint32_t),
+            GPIO_BUS+GPCLR0, (i+1<n_steps ? cb_bus+STEP_CBS*sizeof(dma_cb_t) :
+                (loop ? p_mem->bus : 0)));
+    }
+finish:
+    return ret;
+}
+
+/* 'l' bytes at bus address 'a' inside the memory block */
+#define IN_MEM(p_mem, a, l) \
+    ((a)>=(p_mem)->bus && (l)<=(p_mem)->size && \
+    (size_t)((a)-(p_mem)->bus)<=(p_mem)->size-(l))
+
+#define MEM_PTR(p_mem, a) \
+    ((volatile uint8_t*)(p_mem)->p_virt + ((a)-(p_mem)->bus))
+
+/* exported; see header for details */
+lr_errc_t gpio_wave_dma_exec(const gpio_wave_mem_t *p_mem, uint32_t cb_bus,
+    size_t max_cbs, gpio_wave_wr_t wr, void *arg, size_t *p_n_cbs)
+{
+    size_t n=0;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    for (; cb_bus && (!max_cbs || n<max_cbs); n++)
+    {
+        volatile const dma_cb_t *p_cb;
+        uint32_t i, ti, src, dst, len;
+
+        if ((cb_bus & (sizeof(dma_cb_t)-1)) ||
+            !IN_MEM(p_mem, cb_bus, sizeof(dma_cb_t)))
+        {
+            ret=LREC_DTA_CRPT;
+            goto finish;
+        }
+        p_cb = (volatile const dma_cb_t*)MEM_PTR(p_mem, cb_bus);
+
+        ti = p_cb->ti;
+        src = p_cb->src;
+        dst = p_cb->dst;
+        len = p_cb->len;
+
+        if ((len & (sizeof(uint32_t)-1)) || (!(ti & DMA_TI_SRC_IGNORE) &&
+            !IN_MEM(p_mem, src, (ti & DMA_TI_SRC_INC ? len : sizeof(uint32_t)))))
+        {
+            ret=LREC_DTA_CRPT;
+            goto finish;
+        }
+
+        for (i=0; i<len; i+=sizeof(uint32_t))
+        {
+            uint32_t d = dst + (ti & DMA_TI_DEST_INC ? i : 0);
+            uint32_t val = (ti & DMA_TI_SRC_IGNORE ? 0 :
+                *(volatile uint32_t*)MEM_PTR(p_mem,
+                    src + (ti & DMA_TI_SRC_INC ? i : 0)));
+
+            if (IN_MEM(p_mem, d, sizeof(uint32_t))) {
+                *(volatile uint32_t*)MEM_PTR(p_mem, d) = val;
+            } else
+            if (!wr(arg, d, val)) goto finish;
+        }
+        cb_bus = p_cb->next;
+    }
+finish:
+    if (p_n_cbs) *p_n_cbs = n;
+    return ret;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_wave_init(gpio_wave_t *p_wave, gpio_hndl_t *p_gpio_h,
+    gpio_wave_pace_t pace, unsigned int dma_ch, uint32_t period,
+    size_t max_steps)
+{
+    uint32_t io_base;
+    size_t size = gpio_wave_mem_size(max_steps);
+    lr_errc_t ret=LREC_SUCCESS;
+
+    memset(p_wave, 0, sizeof(*p_wave));
+    p_wave->mbox_fd = -1;
+
+    period = (period+GPIO_WAVE_RES/2)/GPIO_WAVE_RES*GPIO_WAVE_RES;
+
+    if ((pace!=gpio_wave_pace_pwm && pace!=gpio_wave_pace_pcm) || dma_ch>6 ||
+        !max_steps || max_steps>STEPS_MAX || period<GPIO_WAVE_MIN_PERIOD ||
+        (pace==gpio_wave_pace_pcm && period/GPIO_WAVE_RES>1024))
+    {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (!p_gpio_h->io.p_gpio_io) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+
+    p_wave->p_gpio_h = p_gpio_h;
+    p_wave->pace = pace;
+    p_wave->dma_ch = dma_ch;
+    p_wave->period = period;
+    p_wave->max_steps = max_steps;
+
+    if (p_gpio_h->io.sim)
+    {
+        /* the DMA model is run on the process memory */
+        void *p_mem;
+
+        if (posix_memalign(&p_mem, PAGE_SZ, size)) {
+            ret=LREC_NOMEM;
+            goto finish;
+        }
+        p_wave->mem.p_virt = p_mem;
+        p_wave->mem.bus = SIM_MEM_BUS;
+        p_wave->mem.size = size;
+        p_wave->sim = TRUE;
+        goto finish;
+    }
+
+    if (!(io_base = get_bcm_io_base())) {
+        err_printf("[%s] BCM platform not detected\n", __func__);
+        ret=LREC_PLAT_ERR;
+        goto finish;
+    }
+
+    if ((p_wave->mbox_fd = open(MBOX_DEV, O_RDWR))<0) {
+        err_printf("[%s] Open %s error: %d; %s\n",
+            __func__, MBOX_DEV, errno, strerror(errno));
+        ret=LREC_OPEN_ERR;
+        goto finish;
+    }
+    EXEC_RG(mbox_mem_alloc(p_wave->mbox_fd, &p_wave->mem, size));
+
+    if (!(p_wave->p_dma_io =
+            io_mmap_shared("/dev/mem", io_base+DMA_BASE_RA, PAGE_SZ)) ||
+        !(p_wave->p_pace_io = io_mmap_shared("/dev/mem", io_base+
+            (pace==gpio_wave_pace_pwm ? PWM_BASE_RA : I2S_BASE_RA), PAGE_SZ)) ||
+        !(p_wave->p_cm_io =
+            io_mmap_shared("/dev/mem", io_base+CM_BASE_RA, PAGE_SZ)))
+    {
+        ret=LREC_MMAP_ERR;
+        goto finish;
+    }
+finish:
+    if (ret!=LREC_SUCCESS) gpio_wave_free(p_wave);
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_wave_free(gpio_wave_t *p_wave)
+{
+    gpio_wave_stop(p_wave);
+
+    if (p_wave->sim) {
+        free((void*)p_wave->mem.p_virt);
+        memset(&p_wave->mem, 0, sizeof(p_wave->mem));
+        p_wave->sim = FALSE;
+    }
+
+    if (p_wave->p_cm_io) {
+        io_munmap_shared(p_wave->p_cm_io);
+        p_wave->p_cm_io = NULL;
+    }
+    if (p_wave->p_pace_io) {
+        io_munmap_shared(p_wave->p_pace_io);
+        p_wave->p_pace_io = NULL;
+    }
+    if (p_wave->p_dma_io) {
+        io_munmap_shared(p_wave->p_dma_io);
+        p_wave->p_dma_io = NULL;
+    }
+
+    if (p_wave->mbox_fd!=-1) {
+        mbox_mem_free(p_wave->mbox_fd, &p_wave->mem);
+        close(p_wave->mbox_fd);
+        p_wave->mbox_fd = -1;
+    }
+    p_wave->n_steps = 0;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_wave_load(gpio_wave_t *p_wave,
+    const gpio_wave_step_t *p_steps, size_t n_steps, bool_t loop)
+{
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!p_wave->mem.p_virt) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    if (n_steps > p_wave->max_steps) {
+        ret=LREC_NO_SPACE;
+        goto finish;
+    }
+    if (gpio_wave_busy(p_wave)) {
+        ret=LREC_NOT_SUPP;
+        goto finish;
+    }
+    /* stop finished one-shot waveform */
+    gpio_wave_stop(p_wave);
+
+    EXEC_RG(gpio_wave_build(&p_wave->mem, p_steps, n_steps, p_wave->pace, loop));
+    p_wave->n_steps = n_steps;
+    p_wave->loop = loop;
+finish:
+    return ret;
+}
+
+/* Stop the pacing peripheral and its clock.
+ */
+static void pace_stop(gpio_wave_t *p_wave)
+{
+    unsigned int i;
+    uint32_t ctl =
+        (p_wave->pace==gpio_wave_pace_pwm ? CM_PWMCTL : CM_PCMCTL);
+
+    if (p_wave->pace==gpio_wave_pace_pwm) {
+        REG32(p_wave->p_pace_io, PWM_CTL) = 0;
+        REG32(p_wave->p_pace_io, PWM_DMAC) = 0;
+    } else {
+        REG32(p_wave->p_pace_io, PCM_CS_A) = 0;
+    }
+    usleep(10);
+
+    REG32(p_wave->p_cm_io, ctl) = CM_PASSWD|CM_CTL_KILL;
+    for (i=0; i<100 && (REG32(p_wave->p_cm_io, ctl) & CM_CTL_BUSY); i++)
+        usleep(10);
+}
+
+/* Start the pacing peripheral consuming a FIFO word per step period. The FIFO
+   is prefilled to avoid initial steps burst.
+ */
+static void pace_start(gpio_wave_t *p_wave)
+{
+    unsigned int i;
+    volatile void *p_pace_io = p_wave->p_pace_io;
+    uint32_t cnt = p_wave->period/GPIO_WAVE_RES;
+    uint32_t div = (platform_detect()==bcm_2711 ?
+        BCM2711_PLLD_FREQ_HZ : PLLD_FREQ_HZ)/(1000000000U/GPIO_WAVE_RES);
+    uint32_t ctl, dv;
+
+    if (p_wave->pace==gpio_wave_pace_pwm) {
+        ctl = CM_PWMCTL;
+        dv = CM_PWMDIV;
+    } else {
+        ctl = CM_PCMCTL;
+        dv = CM_PCMDIV;
+    }
+
+    pace_stop(p_wave);
+
+    REG32(p_wave->p_cm_io, dv) = CM_PASSWD|CM_DIV_DIVI(div);
+    REG32(p_wave->p_cm_io, ctl) = CM_PASSWD|CM_CTL_SRC_PLLD;
+    REG32(p_wave->p_cm_io, ctl) = CM_PASSWD|CM_CTL_SRC_PLLD|CM_CTL_ENAB;
+    usleep(10);
+
+    if (p_wave->pace==gpio_wave_pace_pwm)
+    {
+        REG32(p_pace_io, PWM_RNG1) = cnt;
+        REG32(p_pace_io, PWM_DMAC) =
+            PWM_DMAC_ENAB|PWM_DMAC_PANIC(15)|PWM_DMAC_DREQ(15);
+        REG32(p_pace_io, PWM_CTL) = PWM_CTL_CLRF1;
+        usleep(10);
+
+        for (i=0; i<FIFO_PREFILL &&
+            !(REG32(p_pace_io, PWM_STA) & PWM_STA_FULL1); i++)
+        {
+            REG32(p_pace_io, PWM_FIF1) = 0;
+        }
+        REG32(p_pace_io, PWM_CTL) = PWM_CTL_USEF1|PWM_CTL_MODE1|PWM_CTL_PWEN1;
+    } else
+    {
+        REG32(p_pace_io, PCM_CS_A) = PCM_CS_EN;
+        REG32(p_pace_io, PCM_TXC_A) = PCM_TXC_CH1EN|PCM_TXC_CH1WID(0);
+        REG32(p_pace_io, PCM_MODE_A) = PCM_MODE_FLEN(cnt-1);
+        REG32(p_pace_io, PCM_CS_A) |= PCM_CS_TXCLR;
+        usleep(10);
+        REG32(p_pace_io, PCM_DREQ_A) = PCM_DREQ_TX_PANIC(16)|PCM_DREQ_TX(30);
+        REG32(p_pace_io, PCM_CS_A) |= PCM_CS_DMAEN;
+
+        for (i=0; i<FIFO_PREFILL &&
+            (REG32(p_pace_io, PCM_CS_A) & PCM_CS_TXD); i++)
+        {
+            REG32(p_pace_io, PCM_FIFO_A) = 0;
+        }
+        REG32(p_pace_io, PCM_CS_A) |= PCM_CS_TXON;
+    }
+}
+
+/* DMA model context of SIM driver */
+typedef struct _sim_ctx_t
+{
+    gpio_wave_t *p_wave;
+    uint64_t next;          /* next step start [ns] */
+} sim_ctx_t;
+
+/* DMA model writes for SIM driver; pacing FIFO writes are timed.
+ */
+static bool_t sim_wr(void *arg, uint32_t bus, uint32_t val)
+{
+    sim_ctx_t *p_ctx = (sim_ctx_t*)arg;
+    gpio_wave_t *p_wave = p_ctx->p_wave;
+
+    if (bus==PWM_FIFO_BUS || bus==PCM_FIFO_BUS)
+    {
+        struct timespec tp;
+
+        if (!ATOMIC_LOAD(p_wave->run)) return FALSE;
+
+        p_ctx->next += p_wave->period;
+        tp.tv_sec = p_ctx->next/1000000000U;
+        tp.tv_nsec = p_ctx->next%1000000000U;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tp, NULL);
+    } else
+    if (bus==GPIO_BUS+GPSET0 || bus==GPIO_BUS+GPCLR0) {
+        REG32(p_wave->p_gpio_h->io.p_gpio_io, bus-GPIO_BUS) = val;
+        sim_sync();
+    }
+    return TRUE;
+}
+
+/* DMA model thread of SIM driver.
+ */
+static void *sim_thrd(void *arg)
+{
+    gpio_wave_t *p_wave = (gpio_wave_t*)arg;
+    sim_ctx_t ctx;
+
+    ctx.p_wave = p_wave;
+    ctx.next = time_ns()-p_wave->period;
+
+    gpio_wave_dma_exec(&p_wave->mem, p_wave->mem.bus, 0, sim_wr, &ctx, NULL);
+
+    ATOMIC_STORE(p_wave->busy, FALSE);
+    return NULL;
+}
+
+/* exported; see header for details */
+lr_errc_t gpio_wave_start(gpio_wave_t *p_wave)
+{
+    bool_t rt;
+    volatile void *p_ch_io;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!p_wave->n_steps) {
+        ret=LREC_NOINIT;
+        goto finish;
+    }
+    if (p_wave->run) {
+        if (gpio_wave_busy(p_wave)) goto finish;
+        /* stop finished one-shot waveform before its restart */
+        gpio_wave_stop(p_wave);
+    }
+
+    if (p_wave->sim) {
+        ATOMIC_STORE(p_wave->busy, TRUE);
+        ATOMIC_STORE(p_wave->run, TRUE);
+
+        if ((ret=thrd_create_rt(&p_wave->thrd, sim_thrd, p_wave, &rt))
+            !=LREC_SUCCESS)
+        {
+            ATOMIC_STORE(p_wave->run, FALSE);
+            ATOMIC_STORE(p_wave->busy, FALSE);
+        }
+        goto finish;
+    }
+
+    pace_start(p_wave);
+
+    p_ch_io = (volatile uint8_t*)p_wave->p_dma_io+DMA_CH_RA(p_wave->dma_ch);
+
+    REG32(p_ch_io, DMA_CS) = DMA_CS_RESET;
+    usleep(10);
+    REG32(p_ch_io, DMA_CS) = DMA_CS_INT|DMA_CS_END;
+    REG32(p_ch_io, DMA_DEBUG) = 7;  /* clear errors */
+    REG32(p_wave->p_dma_io, DMA_ENABLE) |= 1U<<p_wave->dma_ch;
+
+    REG32(p_ch_io, DMA_CONBLK_AD) = p_wave->mem.bus;
+    REG32(p_ch_io, DMA_CS) = DMA_CS_WAIT_WRITES|
+        DMA_CS_PANIC_PRIORITY(8)|DMA_CS_PRIORITY(8)|DMA_CS_ACTIVE;
+
+    p_wave->run = TRUE;
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void gpio_wave_stop(gpio_wave_t *p_wave)
+{
+    if (!p_wave->run) return;
+
+    if (p_wave->sim) {
+        ATOMIC_STORE(p_wave->run, FALSE);
+        pthread_join(p_wave->thrd, NULL);
+    } else {
+        REG32((volatile uint8_t*)p_wave->p_dma_io+DMA_CH_RA(p_wave->dma_ch),
+            DMA_CS) = DMA_CS_RESET;
+        usleep(10);
+        pace_stop(p_wave);
+        p_wave->run = FALSE;
+    }
+}
+
+/* exported; see header for details */
+bool_t gpio_wave_busy(gpio_wave_t *p_wave)
+{
+    if (!p_wave->run) return FALSE;
+
+    if (p_wave->sim) return ATOMIC_LOAD(p_wave->busy);
+
+    return ((REG32((volatile uint8_t*)p_wave->p_dma_io+
+        DMA_CH_RA(p_wave->dma_ch), DMA_CS) & DMA_CS_ACTIVE)!=0);
+}
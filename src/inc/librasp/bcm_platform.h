@@ -26,6 +26,9 @@
 #define BCM2710_PERI_BASE   BCM2709_PERI_BASE
 #define BCM2711_PERI_BASE   0xfe000000
 
+/* I/O peripherals base bus address (as seen by the DMA controller) */
+#define BCM_PERI_BUS_BASE   0x7e000000
+
 /* Real relative base addresses of the I/O peripherals
  */
 /* Fake frame buffer device (actually the multicore sync block */
@@ -41,6 +44,8 @@
 #define ARM_BASE_RA         0xb000
 /* Power Management, Reset controller and Watchdog registers */
 #define PM_BASE_RA          0x100000
+/* Clock manager */
+#define CM_BASE_RA          0x101000
 /* PCM Clock */
 #define PCM_CLOCK_BASE_RA   0x101098
 /* Hardware RNG */
@@ -55,6 +60,8 @@
 #define I2S_BASE_RA         0x203000
 /* SPI0 */
 #define SPI0_BASE_RA        0x204000
+/* PWM */
+#define PWM_BASE_RA         0x20c000
 /* BSC0 I2C/TWI */
 #define BSC0_BASE_RA        0x205000
 /* Uart 1 */
@@ -128,6 +135,11 @@
 #define GPPUDCLK0           0x0098
 /* GPIO Pin Pull-up/down Enable Clock 1 */
 #define GPPUDCLK1           0x009c
+/* GPIO Pull-up/down Control 0-3 (BCM2711 only; 2 bits per GPIO) */
+#define GPIO_PUP_PDN_CNTRL_REG0 0x00e4
+#define GPIO_PUP_PDN_CNTRL_REG1 0x00e8
+#define GPIO_PUP_PDN_CNTRL_REG2 0x00ec
+#define GPIO_PUP_PDN_CNTRL_REG3 0x00f0
 
 /* System Timer Counter (STC) regs
  */
@@ -138,4 +150,121 @@
 /* STC Upper 32 bits */
 #define ST_CHI              0x0008
 
+/* DMA controller regs (channels 0-14; channel's regs block offset)
+ */
+#define DMA_CH_RA(ch)       (0x0100*(ch))
+/* DMA channel control and status */
+#define DMA_CS              0x0000
+/* DMA control block address */
+#define DMA_CONBLK_AD       0x0004
+/* DMA transfer information */
+#define DMA_TI              0x0008
+/* DMA source address */
+#define DMA_SOURCE_AD       0x000c
+/* DMA destination address */
+#define DMA_DEST_AD         0x0010
+/* DMA transfer length */
+#define DMA_TXFR_LEN        0x0014
+/* DMA next control block address */
+#define DMA_NEXTCONBK       0x001c
+/* DMA debug */
+#define DMA_DEBUG           0x0020
+/* DMA global enable bits (relative to the DMA controller base) */
+#define DMA_ENABLE          0x0ff0
+
+/* DMA_CS bits */
+#define DMA_CS_ACTIVE       0x00000001
+#define DMA_CS_END          0x00000002
+#define DMA_CS_INT          0x00000004
+#define DMA_CS_ERROR        0x00000100
+#define DMA_CS_PRIORITY(p)  (((p)&0x0f)<<16)
+#define DMA_CS_PANIC_PRIORITY(p) (((p)&0x0f)<<20)
+#define DMA_CS_WAIT_WRITES  0x10000000
+#define DMA_CS_ABORT        0x40000000
+#define DMA_CS_RESET        0x80000000
+
+/* DMA_TI bits */
+#define DMA_TI_WAIT_RESP    0x00000008
+#define DMA_TI_DEST_INC     0x00000010
+#define DMA_TI_DEST_DREQ    0x00000040
+#define DMA_TI_SRC_INC      0x00000100
+#define DMA_TI_SRC_IGNORE   0x00000800
+#define DMA_TI_PERMAP(p)    (((p)&0x1f)<<16)
+#define DMA_TI_NO_WIDE_BURSTS 0x04000000
+
+/* DMA peripheral DREQ mapping */
+#define DMA_DREQ_PCM_TX     2
+#define DMA_DREQ_PWM        5
+
+/* Clock manager regs
+ */
+/* PCM clock control/divisor */
+#define CM_PCMCTL           0x0098
+#define CM_PCMDIV           0x009c
+/* PWM clock control/divisor */
+#define CM_PWMCTL           0x00a0
+#define CM_PWMDIV           0x00a4
+
+/* CM_XXXCTL, CM_XXXDIV bits */
+#define CM_PASSWD           0x5a000000
+#define CM_CTL_SRC_PLLD     0x00000006
+#define CM_CTL_ENAB         0x00000010
+#define CM_CTL_KILL         0x00000020
+#define CM_CTL_BUSY         0x00000080
+#define CM_DIV_DIVI(d)      (((d)&0x0fff)<<12)
+
+/* PLLD clock frequency [Hz] */
+#define PLLD_FREQ_HZ        500000000
+#define BCM2711_PLLD_FREQ_HZ 750000000
+
+/* PWM regs
+ */
+/* PWM control */
+#define PWM_CTL             0x0000
+/* PWM status */
+#define PWM_STA             0x0004
+/* PWM DMA configuration */
+#define PWM_DMAC            0x0008
+/* PWM channel 1 range */
+#define PWM_RNG1            0x0010
+/* PWM FIFO input */
+#define PWM_FIF1            0x0018
+
+/* PWM_CTL, PWM_STA, PWM_DMAC bits */
+#define PWM_CTL_PWEN1       0x00000001
+#define PWM_CTL_MODE1       0x00000002
+#define PWM_CTL_USEF1       0x00000020
+#define PWM_CTL_CLRF1       0x00000040
+#define PWM_STA_FULL1       0x00000001
+#define PWM_DMAC_DREQ(t)    ((t)&0xff)
+#define PWM_DMAC_PANIC(t)   (((t)&0xff)<<8)
+#define PWM_DMAC_ENAB       0x80000000
+
+/* PCM regs (relative to I2S_BASE_RA)
+ */
+/* PCM control and status */
+#define PCM_CS_A            0x0000
+/* PCM FIFO data */
+#define PCM_FIFO_A          0x0004
+/* PCM mode */
+#define PCM_MODE_A          0x0008
+/* PCM receive configuration */
+#define PCM_RXC_A           0x000c
+/* PCM transmit configuration */
+#define PCM_TXC_A           0x0010
+/* PCM DMA request level */
+#define PCM_DREQ_A          0x0014
+
+/* PCM_CS_A, PCM_MODE_A, PCM_TXC_A, PCM_DREQ_A bits */
+#define PCM_CS_EN           0x00000001
+#define PCM_CS_TXON         0x00000004
+#define PCM_CS_TXCLR        0x00000008
+#define PCM_CS_DMAEN        0x00000200
+#define PCM_CS_TXD          0x00080000
+#define PCM_MODE_FLEN(l)    (((l)&0x3ff)<<10)
+#define PCM_TXC_CH1WID(w)   (((w)&0x0f)<<16)
+#define PCM_TXC_CH1EN       0x40000000
+#define PCM_DREQ_TX(t)      (((t)&0x7f)<<8)
+#define PCM_DREQ_TX_PANIC(t) (((t)&0x7f)<<24)
+
 #endif /* __LR_PLATFORM_H__ */
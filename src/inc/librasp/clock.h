@@ -23,16 +23,33 @@ extern "C" {
 typedef enum _clock_driver_t
 {
     clock_drv_io=0,
-    clock_drv_sys       /* if configured (CONFIG_CLOCK_SYS_DRIVER) */
+    clock_drv_sys,      /* if configured (CONFIG_CLOCK_SYS_DRIVER) */
+    clock_drv_sim,      /* simulated STC (see librasp/sim.h); if configured
+                           (CONFIG_SIM_DRIVER) */
+    clock_drv_auto,     /* the fastest available of io, sys (see
+                           clock_get_drv_probe()); resolved on activation */
+    clock_drv_custom    /* 1st id of drivers registered by
+                           clock_register_driver() */
 } clock_driver_t;
 
+/* Max number of clock drivers (built-in and registered) */
+#define CLOCK_DRV_MAX   8
+
+struct _clock_drv_ops_t;
+
 typedef struct _clock_hndl_t
 {
+    /* active driver and its operations */
     clock_driver_t drv;
+    const struct _clock_drv_ops_t *p_ops;
+
+    /* registered drivers private data */
+    void *drv_data;
 
     /* I/O driver related */
     struct {
         volatile void *p_stc_io;
+        bool_t sim;         /* p_stc_io points to the simulator */
     } io;
 } clock_hndl_t;
 
@@ -50,9 +67,67 @@ lr_errc_t clock_init(clock_hndl_t *p_hndl, clock_driver_t drv);
    For I/O driver may fail for the first-time call on I/O mapping error
    (LREC_MMAP_ERR). Once successes it will always success for the subsequent
    I/O driver activations.
+
+   SIM driver attaches the handle's I/O (p_stc_io) to the simulated STC
+   registers block, which ticks with CLOCK_MONOTONIC [us] time. The I/O and SIM
+   drivers can't be both activated for a single handle (LREC_NOT_SUPP).
+
+   AUTO driver activates the fastest driver selected by the drivers probing
+   (see clock_get_drv_probe()); the handle's 'drv' is set to the selected
+   driver. The function fails with LREC_NOT_SUPP if none of the probed drivers
+   is available.
+
+   NOTE: The clock ticks unit depends on the driver ([us] for I/O, [ns] for
+   SYS), therefore the handle's 'drv' should be checked after AUTO driver
+   activation if the ticks are to be converted to time.
  */
 lr_errc_t clock_set_driver(clock_hndl_t *p_hndl, clock_driver_t drv);
 
+/* Built-in drivers probing results (see gpio_drv_probe_t).
+ */
+typedef struct _clock_drv_probe_t
+{
+    /* selected (the fastest available) driver; -1 if none is available */
+    clock_driver_t drv;
+
+    /* per-operation costs [ns] of the probed drivers indexed by the driver id;
+       0 if the driver is not available (or not probed) */
+    uint32_t costs[clock_drv_auto];
+} clock_drv_probe_t;
+
+/* Get the built-in drivers probing results. The probing is performed once per
+   process, on the first AUTO driver activation or this function call.
+
+   The I/O and SYS (if configured) drivers are probed in this order. The I/O
+   driver is available if the BCM platform is detected, /dev/mem is accessible
+   and the STC registers are mapped successfully. The driver's cost is measured
+   by a short series of clock_get_ticks32() calls. A driver is selected over
+   the previously probed one if it's at least 10% faster.
+ */
+void clock_get_drv_probe(clock_drv_probe_t *p_probe);
+
+/* Clock driver operations (see gpio_drv_ops_t for details).
+ */
+typedef struct _clock_drv_ops_t
+{
+    lr_errc_t (*init)(clock_hndl_t *p_hndl);
+    void (*free)(clock_hndl_t *p_hndl);
+
+    lr_errc_t (*get_ticks32)(clock_hndl_t *p_hndl, uint32_t *p_ticks);
+    lr_errc_t (*get_ticks64)(clock_hndl_t *p_hndl, uint64_t *p_ticks);
+    lr_errc_t (*usleep)(clock_hndl_t *p_hndl, uint32_t usec);
+} clock_drv_ops_t;
+
+/* Register clock driver implemented outside the library by its operations
+   'p_ops' (see gpio_register_driver() for details).
+
+   NOTE: Unless the library is configured with CONFIG_CLOCK_SYS_DRIVER the
+   library's devices don't check the clock operations return codes (they are
+   assumed to always success).
+ */
+lr_errc_t
+    clock_register_driver(const clock_drv_ops_t *p_ops, clock_driver_t *p_drv);
+
 /* Free clock handle
  */
 void clock_free(clock_hndl_t *p_hndl);
@@ -62,9 +137,11 @@ void clock_free(clock_hndl_t *p_hndl);
 
    Operation performed by the functions and its result depends on the active
    driver already set:
-   - For the I/O driver the functions always success,
+   - For the I/O and SIM drivers the functions always success,
    - If configured the function may fail for the SYS driver if the underlying
      system function fails.
+   - LREC_NOINIT is returned for a handle with no active driver (initialization
+     failed or the handle freed).
  */
 lr_errc_t clock_get_ticks32(clock_hndl_t *p_hndl, uint32_t *p_ticks);
 lr_errc_t clock_get_ticks64(clock_hndl_t *p_hndl, uint64_t *p_ticks);
@@ -73,9 +150,11 @@ lr_errc_t clock_get_ticks64(clock_hndl_t *p_hndl, uint64_t *p_ticks);
 
    Operation performed by the function and its result depends on the active
    driver already set:
-   - For the I/O driver the functions always success,
+   - For the I/O and SIM drivers the functions always success,
    - If configured the function may fail for the SYS driver if the underlying
      system function fails.
+   - LREC_NOINIT is returned for a handle with no active driver (initialization
+     failed or the handle freed).
  */
 lr_errc_t clock_usleep(clock_hndl_t *p_hndl, uint32_t usec);
 
@@ -34,6 +34,7 @@ extern "C" {
 
 #define DEV_MEM_IO      "/dev/mem"
 #define DEV_MEM_GPIO    "/dev/gpiomem"
+#define DEV_GPIOCHIP    "/dev/gpiochip0"
 
 typedef int bool_t;
 
@@ -99,7 +100,9 @@ typedef enum _platform_t
     bcm_2711
 } platform_t;
 
-/* Platform type detection. Returns -1 in case the platform can't be recognized
+/* Platform type detection. Returns -1 in case the platform can't be recognized.
+   The detection is performed once per process, subsequent calls return the
+   cached result.
  */
 platform_t platform_detect();
 
@@ -115,13 +118,23 @@ platform_t platform_detect();
 #define IO_REG32_PTR(b, r) (volatile uint32_t*)((volatile uint8_t*)(b)+(r))
 
 /* Get BCM SoC I/O peripherals base address. Returns 0 in case the platform
-   (and therefore I/O base) can't be recognized
+   (and therefore I/O base) can't be recognized. For a recognized BCM platform
+   the base is read from the device tree (/proc/device-tree/soc/ranges) if
+   available, otherwise it's deduced from the platform type. The result is
+   cached.
  */
 uint32_t get_bcm_io_base();
 
 /* Map memory I/O into the virtual space; return NULL in case of error */
 volatile void *io_mmap(const char *dev, uint32_t io_base, uint32_t len);
 
+/* Shared, reference counted version of io_mmap(). All the mappings of the same
+   block (device, base and length) share a single mapping, which is unmapped by
+   io_munmap_shared() of the last user. The functions are thread-safe.
+ */
+volatile void *io_mmap_shared(const char *dev, uint32_t io_base, uint32_t len);
+void io_munmap_shared(volatile void *p_io);
+
 /* Bytes 'in' to hex conversion (written into 'out') */
 void bts2hex(const uint8_t *p_in, size_t in_len, char *outstr);
 
@@ -0,0 +1,104 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_DEVS_QENC_H__
+#define __LR_DEVS_QENC_H__
+
+#include <pthread.h>
+#include "librasp/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Max number of encoders served by a decoder object */
+#define QENC_MAX_ENCS   (GPIO_NUM/2)
+
+typedef struct _qenc_enc_t
+{
+    unsigned int a_gpio;
+    unsigned int b_gpio;
+
+    /* published by the sampling thread; read atomically */
+    int64_t count;          /* position counter */
+    int32_t vel;            /* velocity [counts/s] */
+    uint64_t n_errs;        /* number of illegal transitions (both A/B
+                               changed between consecutive samples) */
+
+    /* sampling thread private */
+    unsigned int ab;        /* last A/B state */
+    int64_t vel_count;      /* count at the velocity window start */
+} qenc_enc_t;
+
+typedef struct _qenc_t
+{
+    gpio_hndl_t *p_gpio_h;
+    uint32_t rate;          /* sampling rate [Hz] */
+    uint32_t vel_ticks;     /* velocity window [ticks] */
+
+    unsigned int n_encs;
+    qenc_enc_t encs[QENC_MAX_ENCS];
+    uint64_t pins;          /* encoders GPIOs */
+
+    /* sampling thread related */
+    pthread_t thrd;
+    bool_t run;
+    bool_t rt;              /* real-time scheduler set */
+    uint64_t n_ticks;       /* number of sampling ticks */
+    uint64_t n_overruns;    /* number of missed ticks */
+} qenc_t;
+
+/* Initialize quadrature encoders decoder object sampling GPIOs via 'p_gpio_h'
+   handle with 'rate' [Hz]. Encoders velocities are calculated over 'vel_win'
+   [ms] window. The GPIO handle must be valid for the whole life time of the
+   object.
+
+   All the encoders A/B inputs are read by single gpio_read_bank() per tick
+   (single GPLEV0 read for the I/O driver if all the GPIOs are in the 1st
+   bank) and decoded by the 16-entry transitions table.
+ */
+lr_errc_t qenc_init(qenc_t *p_qenc,
+    gpio_hndl_t *p_gpio_h, uint32_t rate, uint32_t vel_win);
+
+/* Free decoder object; the sampling is stopped if running.
+ */
+void qenc_free(qenc_t *p_qenc);
+
+/* Add an encoder connected to 'a_gpio', 'b_gpio' inputs. The encoder id
+   (used for qenc_read()) is written under 'p_id'. Encoders may be added for
+   stopped decoder only.
+
+   GPIO pre-call state:
+       A, B [in]: pull configuration depends on requirements.
+ */
+lr_errc_t qenc_add(qenc_t *p_qenc,
+    unsigned int a_gpio, unsigned int b_gpio, unsigned int *p_id);
+
+/* Start/stop the sampling thread. The thread is run with the real-time
+   scheduler of the maximum priority (if allowed). Encoders counters are
+   zeroed on start.
+ */
+lr_errc_t qenc_start(qenc_t *p_qenc);
+void qenc_stop(qenc_t *p_qenc);
+
+/* Read encoder 'id' signed count, velocity [counts/s] and illegal transitions
+   counter (any of the pointers may be NULL). The function is lock-free and
+   may be called at any time from any thread.
+ */
+lr_errc_t qenc_read(qenc_t *p_qenc, unsigned int id,
+    int64_t *p_count, int32_t *p_vel, uint64_t *p_n_errs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_DEVS_QENC_H__ */
@@ -24,28 +24,69 @@ typedef enum _gpio_driver_t
 {
     gpio_drv_io=0,  /* /dev/mem mapped */
     gpio_drv_gpio,  /* /dev/gpiomem mapped */
-    gpio_drv_sysfs
+    gpio_drv_sysfs,
+    gpio_drv_cdev,  /* /dev/gpiochipN; if configured (CONFIG_GPIO_CDEV_DRIVER) */
+    gpio_drv_sim,   /* simulated BCM's GPIO (see librasp/sim.h); if configured
+                       (CONFIG_SIM_DRIVER) */
+    gpio_drv_auto,  /* the fastest available of io, gpio, cdev or sysfs as
+                       fallback (see gpio_get_drv_probe()); resolved on
+                       activation; GPIOs must be prepared by gpio_prepare()
+                       before usage */
+    gpio_drv_custom /* 1st id of drivers registered by gpio_register_driver() */
 } gpio_driver_t;
 
+/* Max number of GPIO drivers (built-in and registered) */
+#define GPIO_DRV_MAX    16
+
+struct _gpio_drv_ops_t;
+
 typedef struct _gpio_hndl_t
 {
-    /* active driver */
+    /* active driver and its operations */
     gpio_driver_t drv;
+    const struct _gpio_drv_ops_t *p_ops;
+
+    /* registered drivers private data */
+    void *drv_data;
 
     /* I/O driver */
     struct {
         volatile void *p_gpio_io;
+        platform_t plat;    /* detected on the I/O mapping */
+        bool_t sim;         /* p_gpio_io points to the simulator */
     } io;
 
-    /* SYSFS driver */
+    /* SYSFS driver; handles are kept open until unexport or the handle free */
     struct {
-        int valfds[GPIO_NUM];  /* GPIO values handles */
+        int valfds[GPIO_NUM];   /* GPIO values handles */
+        int dirfds[GPIO_NUM];   /* GPIO directions handles */
+        int edgefds[GPIO_NUM];  /* GPIO edges handles */
+        int8_t dirs[GPIO_NUM];  /* cached directions (out: 1, -1: unknown) */
+        int8_t edges[GPIO_NUM]; /* cached edges (GPIO_EVENT_XXX, -1: unknown) */
     } sysfs;
+
+    /* CDEV driver */
+    struct {
+        char chip[64];          /* GPIO chip device path */
+        int chipfd;             /* GPIO chip handle */
+        int reqfd;              /* requested lines handle */
+        unsigned int req_id;    /* lines request id (changed on re-request) */
+        uint64_t lines;         /* requested lines (GPIOs mask) */
+        uint64_t outvals;       /* output lines values */
+        uint64_t flags[GPIO_NUM];   /* lines configuration flags */
+        unsigned int ev_bufsz;  /* kernel events buffer size (0: default) */
+    } cdev;
 } gpio_hndl_t;
 
 /* Initialize GPIO handle and set a given driver as active for the handle.
 
    NOTE: The initiated handle may be freely shared between all GPIO operations.
+   NOTE: For the I/O and SIM drivers the BCM's registers read-modify-write
+   sequences (GPFSELn, event detect enables, pulls configuration) are
+   serialized by process-wide locks, therefore GPIOs sharing the registers may
+   be configured concurrently by multiple threads (handles). GPSETn, GPCLRn,
+   GPLEVn accesses are lock-free. The serialization doesn't cover other
+   processes mapping the GPIO registers.
  */
 lr_errc_t gpio_init(gpio_hndl_t *p_hndl, gpio_driver_t drv);
 
@@ -54,14 +95,116 @@ lr_errc_t gpio_init(gpio_hndl_t *p_hndl, gpio_driver_t drv);
 
    This function always successes for SYSFS driver. For I/O driver may fail for
    the first-time call on I/O mapping error (LREC_MMAP_ERR). Once successes it
-   will always success for the subsequent I/O driver activations.
+   will always success for the subsequent I/O driver activations. For CDEV
+   driver the function opens the GPIO chip (see gpio_cdev_set_chip()) and may
+   fail on the chip open error (LREC_OPEN_ERR) or return LREC_NOT_SUPP if the
+   driver is not configured.
+
+   For a registered driver the function fails with LREC_INV_ARG if the driver
+   is not registered or with the driver's 'init' error.
+
+   SIM driver attaches the handle's I/O (p_gpio_io) to the simulated GPIO
+   registers block, therefore the I/O driver related API works on the
+   simulator (see librasp/sim.h for the fast path accesses limitation). As the
+   I/O is shared, I/O (or GPIO) and SIM drivers can't be both activated for a
+   single handle (LREC_NOT_SUPP).
+
+   AUTO driver activates the fastest driver selected by the drivers probing
+   (see gpio_get_drv_probe()); the handle's 'drv' is set to the selected
+   driver. The function fails with LREC_NOT_SUPP if none of the probed drivers
+   is available. As the selected driver may be CDEV or SYSFS, requiring the
+   GPIOs to be requested (exported) before their usage, GPIOs of the handle
+   with AUTO driver activated should be prepared by gpio_prepare().
  */
 lr_errc_t gpio_set_driver(gpio_hndl_t *p_hndl, gpio_driver_t drv);
 
+/* Built-in drivers probing results.
+ */
+typedef struct _gpio_drv_probe_t
+{
+    /* selected (the fastest available) driver; -1 if none is available */
+    gpio_driver_t drv;
+
+    /* per-operation costs [ns] of the probed drivers indexed by the driver id;
+       0 if the driver is not available (or not probed; SYSFS is never probed).
+       The costs are of the drivers probing operations (see
+       gpio_get_drv_probe()), which for CDEV is not a GPIO access but a kernel
+       round-trip of comparable path, therefore it's an estimate to compare
+       the drivers only. */
+    uint32_t costs[gpio_drv_auto];
+} gpio_drv_probe_t;
+
+/* Get the built-in drivers probing results. The probing is performed once per
+   process, on the first AUTO driver activation or this function call.
+
+   The I/O, GPIO and CDEV drivers are probed in this order. A driver is
+   available if its access path is (the BCM platform detected and /dev/mem,
+   /dev/gpiomem accessible for I/O, GPIO drivers; DEV_GPIOCHIP accessible for
+   CDEV) and the driver activates successfully. The driver's cost is measured
+   by a short series of its non-intrusive operations (the GPIO levels read for
+   the memory mapped drivers; GPIO chip line info ioctl for CDEV), so it
+   doesn't change any GPIO configuration. A driver is selected over the
+   previously probed one if it's at least 10% faster. SYSFS driver can't be
+   probed w/o exporting a GPIO, therefore it's selected only if none of the
+   probed drivers is available and /sys/class/gpio/export is writable.
+ */
+void gpio_get_drv_probe(gpio_drv_probe_t *p_probe);
+
+/* Prepare/unprepare GPIOs specified by 'mask' (OR'ed GPIO_MASK() values) for
+   usage with the handle's active driver, regardless of the driver: the GPIOs
+   are requested (released) for the CDEV driver, exported (unexported) for the
+   SYSFS driver (see gpio_sysfs_export_many() for 'timeout'), no-op for other
+   drivers. LREC_INV_ARG is returned if 'mask' specifies GPIO out of the
+   platform range.
+ */
+lr_errc_t gpio_prepare(gpio_hndl_t *p_hndl, uint64_t mask, int timeout);
+lr_errc_t gpio_unprepare(gpio_hndl_t *p_hndl, uint64_t mask);
+
+/* GPIO driver operations.
+
+   The operations table is selected by gpio_set_driver() and the GPIO API calls
+   are dispatched via the handle's table, therefore each of them costs a single
+   indirect call regardless of the number of supported drivers. The API
+   validates GPIO numbers (masks) before calling the operations and returns
+   LREC_NOINIT for a handle with no active driver (initialization failed or
+   the handle freed).
+
+   'init' is called on a driver activation for a handle (if not active yet),
+   'free' on its deactivation (another driver activated) or the handle free.
+   Both are optional for registered drivers and not used by the built-in ones.
+ */
+typedef struct _gpio_drv_ops_t
+{
+    lr_errc_t (*init)(gpio_hndl_t *p_hndl);
+    void (*free)(gpio_hndl_t *p_hndl);
+
+    lr_errc_t (*direction_input)(gpio_hndl_t *p_hndl, unsigned int gpio);
+    lr_errc_t (*direction_output)(
+        gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val);
+    lr_errc_t (*get_value)(
+        gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_val);
+    lr_errc_t (*set_value)(
+        gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val);
+    lr_errc_t (*write_bank)(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val);
+    lr_errc_t (*read_bank)(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_levs);
+    lr_errc_t (*set_event)(
+        gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event);
+} gpio_drv_ops_t;
+
+/* Register GPIO driver implemented outside the library by its operations
+   'p_ops' (all operations except 'init' and 'free' are mandatory). The table
+   must be valid for the whole process life time. The assigned driver id (to be
+   passed to gpio_init(), gpio_set_driver()) is written under 'p_drv'.
+   LREC_NO_SPACE is returned if there is no more room for drivers (see
+   GPIO_DRV_MAX).
+ */
+lr_errc_t gpio_register_driver(const gpio_drv_ops_t *p_ops, gpio_driver_t *p_drv);
+
 /* Free GPIO handle.
 
    NOTE: The function doesn't unexport exported GPIOs for the SYSFS driver. It
-   need to be done via gpio_sysfs_unexport().
+   need to be done via gpio_sysfs_unexport(). Lines requested for the CDEV
+   driver are released.
  */
 void gpio_free(gpio_hndl_t *p_hndl);
 
@@ -73,9 +216,11 @@ void gpio_free(gpio_hndl_t *p_hndl);
      was passed),
    - For SYSFS driver the function may fail if the requested GPIO has not been
      exported or due to sysfs access error.
+   - For CDEV driver the function may fail if the GPIO line has not been
+     requested (LREC_NOINIT) or due to ioctl() error.
 
-   NOTE: For I/O driver gpio_direction_output() function guarantees no GPIO
-   output blink with requested value after switching to the output mode.
+   NOTE: For I/O and CDEV drivers gpio_direction_output() function guarantees
+   no GPIO output blink with requested value after switching to the output mode.
  */
 lr_errc_t gpio_direction_input(gpio_hndl_t *p_hndl, unsigned int gpio);
 lr_errc_t gpio_direction_output(
@@ -89,6 +234,8 @@ lr_errc_t gpio_direction_output(
      was passed),
    - For SYSFS driver the function may fail if the requested GPIO has not been
      set as an input or output (LREC_NOINIT) or due to sysfs access error.
+   - For CDEV driver the function may fail if the GPIO line has not been
+     requested (LREC_NOINIT) or due to ioctl() error.
 
    NOTE: For BCM chip the GPIO outputs are of push-pull type. Open-drain/source
    outputs may be emulated by proper pull up/down resistor configuration
@@ -100,6 +247,127 @@ lr_errc_t gpio_get_value(
 lr_errc_t gpio_set_value(
     gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val);
 
+/* GPIO bit mask used by the bank-wide API. Bits 0-31 correspond to the BCM's
+   bank 0 GPIOs (GPSET0, GPCLR0, GPLEV0 registers), bits 32-53 to the bank 1.
+ */
+#define GPIO_MASK(n)    ((uint64_t)1<<(n))
+#define GPIO_MASK_ALL   (GPIO_MASK(GPIO_NUM)-1)
+
+/* Set (high) or clear (low) all GPIOs specified by 'mask' (OR'ed GPIO_MASK()
+   values). gpio_write_bank() sets GPIOs from 'mask' to their corresponding
+   bits values in 'val'.
+
+   For I/O driver each of the functions performs at most one GPSETn/GPCLRn
+   register write per bank, therefore all GPIOs of the same bank are set (or
+   cleared) simultaneously. Note gpio_write_bank() writes GPSETn before GPCLRn,
+   so pins going high in a bank change slightly before the ones going low.
+   For CDEV driver the GPIOs are written by a single ioctl() call and all of
+   them must be requested (LREC_NOINIT otherwise). For SYSFS driver the GPIOs
+   are written one by one (in the increasing number order) and the functions
+   return on the first failure.
+
+   LREC_INV_ARG is returned if 'mask' specifies GPIO out of the platform range.
+ */
+lr_errc_t gpio_set_mask(gpio_hndl_t *p_hndl, uint64_t mask);
+lr_errc_t gpio_clr_mask(gpio_hndl_t *p_hndl, uint64_t mask);
+lr_errc_t gpio_write_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val);
+
+/* Read levels of GPIOs specified by 'mask' (OR'ed GPIO_MASK() values) and
+   write them under 'p_levs' as a bank-wide snapshot (GPIO_MASK(n) bit
+   corresponds to the n-th GPIO level). Bits of GPIOs not specified by 'mask'
+   are zeroed.
+
+   For I/O driver the function reads at most two registers (GPLEV0, GPLEV1);
+   a register of the bank not covered by 'mask' is not read at all. Therefore
+   levels of all GPIOs of the same bank are sampled at the same time. For CDEV
+   driver the GPIOs are read by a single ioctl() call and all of them must be
+   requested (LREC_NOINIT otherwise). For SYSFS driver the GPIOs are read one
+   by one and the function fails as gpio_get_value() does.
+
+   LREC_INV_ARG is returned if 'mask' specifies GPIO out of the platform range.
+ */
+lr_errc_t gpio_read_bank(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_levs);
+
+/* Get level (0 or 1) of 'gpio' from the snapshot read by gpio_read_bank().
+ */
+#define GPIO_LEV(levs, gpio) ((unsigned int)(((levs)>>(gpio))&1))
+
+/* Extract levels of GPIOs specified by 'mask' from the snapshot read by
+   gpio_read_bank() and pack them into consecutive bits of the returned value
+   (the lowest GPIO from 'mask' goes into the 0-bit of the result etc.).
+ */
+static inline uint64_t gpio_bank_extract(uint64_t levs, uint64_t mask)
+{
+    uint64_t ret=0, bt=1;
+
+    for (; mask; mask&=mask-1, bt<<=1) {
+        if (levs & mask & -mask) ret|=bt;
+    }
+    return ret;
+}
+
+/* I/O driver fast path.
+
+   The inline functions below access the BCM's GPIO registers directly via
+   already mapped I/O (p_gpio_io) with no driver dispatch and no arguments
+   checks. They are intended for timing critical (e.g. bit-banging) loops.
+   If GPIO numbers (masks) are known at compile time the register offsets and
+   bit masks are folded into constants.
+
+   NOTE: The caller is responsible to pass proper GPIO numbers (masks) and
+   the handle with initialized I/O driver (see gpio_set_driver()).
+   NOTE: For the SIM driver the simulator must be synchronized by the caller
+   (see librasp/sim.h).
+ */
+static inline void
+    gpio_io_set_fast(gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int val)
+{
+    *IO_REG32_PTR(p_hndl->io.p_gpio_io,
+        (val ? GPSET0 : GPCLR0)+sizeof(uint32_t)*(gpio>>5)) =
+        (uint32_t)1<<(gpio&0x1f);
+}
+
+static inline unsigned int
+    gpio_io_get_fast(gpio_hndl_t *p_hndl, unsigned int gpio)
+{
+    return (unsigned int)((*IO_REG32_PTR(p_hndl->io.p_gpio_io,
+        GPLEV0+sizeof(uint32_t)*(gpio>>5))>>(gpio&0x1f))&1);
+}
+
+static inline void gpio_io_set_mask_fast(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    if ((uint32_t)mask)
+        *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPSET0) = (uint32_t)mask;
+    if ((uint32_t)(mask>>32))
+        *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPSET1) = (uint32_t)(mask>>32);
+}
+
+static inline void gpio_io_clr_mask_fast(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    if ((uint32_t)mask)
+        *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPCLR0) = (uint32_t)mask;
+    if ((uint32_t)(mask>>32))
+        *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPCLR1) = (uint32_t)(mask>>32);
+}
+
+static inline void
+    gpio_io_write_bank_fast(gpio_hndl_t *p_hndl, uint64_t mask, uint64_t val)
+{
+    gpio_io_set_mask_fast(p_hndl, mask&val);
+    gpio_io_clr_mask_fast(p_hndl, mask&~val);
+}
+
+static inline uint64_t gpio_io_read_bank_fast(gpio_hndl_t *p_hndl, uint64_t mask)
+{
+    uint64_t levs=0;
+
+    if ((uint32_t)mask)
+        levs = *IO_REG32_PTR(p_hndl->io.p_gpio_io, GPLEV0);
+    if ((uint32_t)(mask>>32))
+        levs |= (uint64_t)*IO_REG32_PTR(p_hndl->io.p_gpio_io, GPLEV1)<<32;
+    return levs&mask;
+}
+
 /* Emulate open-drain output. In the high state the GPIO pin is configured as
    an input and may be read.
    NOTE: Open drain emulation may be performed only with a pull-up resistor
@@ -137,6 +405,9 @@ lr_errc_t gpio_set_value(
      a proper GPIO number was passed).
    - For SYSFS driver the function may fail if the requested GPIO has not been
      exported or due to sysfs access error.
+   - For CDEV driver the function may fail if the GPIO line has not been
+     requested (LREC_NOINIT) or due to ioctl() error. The event detection is
+     effective for input lines only.
  */
 lr_errc_t gpio_set_event(
     gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int event);
@@ -152,6 +423,40 @@ lr_errc_t gpio_set_event(
 lr_errc_t gpio_bcm_get_event_stat(
     gpio_hndl_t *p_hndl, unsigned int gpio, unsigned int *p_stat);
 
+/* Get BCM's events status of GPIOs specified by 'mask' (OR'ed GPIO_MASK()
+   values). GPEDS0/GPEDS1 registers (only those covering 'mask') are read once
+   and exactly the read detected events of the 'mask' GPIOs are cleared,
+   therefore events of other GPIOs or detected after the read are not lost.
+   Mask of the detected events is written under 'p_pend'. LREC_INV_ARG is
+   returned if 'mask' specifies GPIO out of the platform range.
+
+   NOTE: The function has the same requirements as gpio_bcm_get_event_stat().
+ */
+lr_errc_t gpio_bcm_get_events(
+    gpio_hndl_t *p_hndl, uint64_t mask, uint64_t *p_pend);
+
+/* BCM's event handler called by gpio_bcm_dispatch_events() for 'gpio' with
+   detected event.
+ */
+typedef void (*gpio_bcm_event_cb_t)(
+    gpio_hndl_t *p_hndl, unsigned int gpio, void *arg);
+
+typedef struct _gpio_bcm_event_hndlr_t
+{
+    gpio_bcm_event_cb_t cb;     /* NULL: no handler */
+    void *arg;
+} gpio_bcm_event_hndlr_t;
+
+/* Get BCM's events status of GPIOs specified by 'mask' as gpio_bcm_get_events()
+   and call handlers of the GPIOs with detected events (in the GPIOs ascending
+   order). 'p_hndlrs' is GPIO_NUM long table of handlers indexed by GPIO
+   number. Mask of the detected events is written under 'p_pend' (may be NULL).
+
+   NOTE: The function has the same requirements as gpio_bcm_get_event_stat().
+ */
+lr_errc_t gpio_bcm_dispatch_events(gpio_hndl_t *p_hndl, uint64_t mask,
+    const gpio_bcm_event_hndlr_t *p_hndlrs, uint64_t *p_pend);
+
 /* BCM's GPIO functions specification. */
 typedef enum _gpio_bcm_func_t
 {
@@ -177,6 +482,32 @@ lr_errc_t gpio_bcm_get_func(
 lr_errc_t gpio_bcm_set_func(
     gpio_hndl_t *p_hndl, unsigned int gpio, gpio_bcm_func_t func);
 
+/* GPIO to BCM's function assignment (see gpio_bcm_set_func_many()) */
+typedef struct _gpio_bcm_func_cfg_t
+{
+    unsigned int gpio;
+    gpio_bcm_func_t func;
+} gpio_bcm_func_cfg_t;
+
+/* Set BCM's functions of many GPIOs at once. gpio_bcm_set_func_many() assigns
+   functions as specified by 'n_cfg' long table 'p_cfg' (if a GPIO is specified
+   more than once, the last assignment is taken), gpio_bcm_set_func_mask()
+   assigns 'func' to all GPIOs specified by 'mask' (OR'ed GPIO_MASK() values).
+
+   The GPIOs are grouped by GPFSELn registers and each of the affected registers
+   is read and written only once. The arguments are validated before any
+   register is written (LREC_INV_ARG on failure).
+
+   NOTE: To configure many GPIOs as outputs w/o output blink set the outputs
+   values by gpio_write_bank() before switching them to the output function.
+
+   NOTE: The functions require initialized I/O driver (see gpio_bcm_set_func()).
+ */
+lr_errc_t gpio_bcm_set_func_many(gpio_hndl_t *p_hndl,
+    const gpio_bcm_func_cfg_t *p_cfg, size_t n_cfg);
+lr_errc_t gpio_bcm_set_func_mask(
+    gpio_hndl_t *p_hndl, uint64_t mask, gpio_bcm_func_t func);
+
 /* BCM's GPIO input pull resistor configuration */
 typedef enum _gpio_bcm_pull_t
 {
@@ -195,6 +526,54 @@ typedef enum _gpio_bcm_pull_t
 lr_errc_t gpio_bcm_set_pull_config(
     gpio_hndl_t *p_hndl, unsigned int gpio, gpio_bcm_pull_t pull);
 
+/* Set pull resistor configuration 'pull' for all GPIOs specified by 'mask'
+   (OR'ed GPIO_MASK() values).
+
+   On BCM2711 the pulls are set directly via GPIO_PUP_PDN_CNTRL_REGn registers
+   (each register is written once per 16 GPIOs). On older SoCs all the GPIOs
+   are configured by single GPPUD/GPPUDCLKn clocking sequence.
+
+   NOTE: The function requires initialized I/O driver (see
+   gpio_bcm_set_pull_config()).
+ */
+lr_errc_t gpio_bcm_set_pull_many(
+    gpio_hndl_t *p_hndl, uint64_t mask, gpio_bcm_pull_t pull);
+
+/* BCM's GPIO context */
+typedef struct _gpio_bcm_ctx_t
+{
+    uint32_t gpfsel[6];     /* GPFSEL0-5 */
+    uint64_t levs;          /* output levels of GPIOs configured as outputs */
+    /* event detect enables (GPRENn, GPFENn, GPHENn, GPLENn, GPARENn, GPAFENn) */
+    uint64_t ren;
+    uint64_t fen;
+    uint64_t hen;
+    uint64_t len;
+    uint64_t aren;
+    uint64_t afen;
+} gpio_bcm_ctx_t;
+
+/* Save BCM's GPIO context (GPIOs functions, output levels and event detect
+   enables) under 'p_ctx'.
+
+   NOTE: The function requires initialized I/O driver (see
+   gpio_bcm_set_pull_config()).
+ */
+lr_errc_t gpio_bcm_save_ctx(gpio_hndl_t *p_hndl, gpio_bcm_ctx_t *p_ctx);
+
+/* Restore BCM's GPIO context previously saved by gpio_bcm_save_ctx(). Only
+   registers differing from the saved context are written. Output levels are
+   restored before switching GPIOs functions, therefore outputs don't blink.
+
+   NOTE: Event detect enables are restored only if the library is compiled with
+   CONFIG_BCM_GPIO_EVENTS, otherwise they are left untouched. Pull resistors
+   configuration is not a part of the context.
+
+   NOTE: The function requires initialized I/O driver (see
+   gpio_bcm_set_pull_config()).
+ */
+lr_errc_t gpio_bcm_restore_ctx(gpio_hndl_t *p_hndl, const gpio_bcm_ctx_t *p_ctx);
+
 /* Export/unexport a GPIO for the SYSFS driver. Any GPIO MUST be exported via
    gpio_sysfs_export() before its usage with SYSFS driver. If the GPIO is no
    more needed a library user should call gpio_sysfs_unexport() to return the
@@ -203,6 +582,22 @@ lr_errc_t gpio_bcm_set_pull_config(
 lr_errc_t gpio_sysfs_export(gpio_hndl_t *p_hndl, unsigned int gpio);
 lr_errc_t gpio_sysfs_unexport(gpio_hndl_t *p_hndl, unsigned int gpio);
 
+/* Export GPIOs specified by 'mask' (OR'ed GPIO_MASK() values) for the SYSFS
+   driver. The export file is written in one go for all the GPIOs, then the
+   function waits up to 'timeout' milliseconds (infinite time if <0) for the
+   GPIOs sysfs attributes to be accessible (the access rights are set
+   asynchronously by udev) and opens their value and direction handles.
+   LREC_TIMEOUT is returned if the attributes haven't become accessible in the
+   given time. LREC_INV_ARG is returned if 'mask' specifies GPIO out of the
+   platform range.
+
+   NOTE: The SYSFS driver caches the GPIOs direction and edge settings and
+   skips their redundant writes. Changing the settings of GPIOs in use by other
+   means (e.g. the shell) is not recognized by the driver.
+ */
+lr_errc_t gpio_sysfs_export_many(
+    gpio_hndl_t *p_hndl, uint64_t mask, int timeout);
+
 /* Poll for an event for 'gpio'. The event must be already set by gpio_set_event().
    The polling timeouts by 'timeout' milliseconds (infinite time if <0). If the
    event is detected LREC_SUCCESS is returned, LREC_TIMEOUT means timeout, other
@@ -214,6 +609,78 @@ lr_errc_t gpio_sysfs_unexport(gpio_hndl_t *p_hndl, unsigned int gpio);
  */
 lr_errc_t gpio_sysfs_poll(gpio_hndl_t *p_hndl, unsigned int gpio, int timeout);
 
+/* Set GPIO chip device path used by the CDEV driver (DEV_GPIOCHIP by default).
+   The already opened chip is closed and its requested lines are released,
+   therefore the function should be called before the driver activation.
+ */
+lr_errc_t gpio_cdev_set_chip(gpio_hndl_t *p_hndl, const char *chip);
+
+/* Request/release GPIO lines specified by 'mask' (OR'ed GPIO_MASK() values) for
+   the CDEV driver. Any GPIO line MUST be requested before its usage with the
+   CDEV driver. Newly requested lines are configured as inputs.
+
+   All lines of the handle are held by a single kernel's lines request, which
+   enables their multi-line access by a single ioctl() call. The lines request
+   is re-created on each call of these functions (the configuration of the
+   lines kept requested is preserved), therefore all lines should be requested
+   at once if possible. If the request fails the previously requested lines are
+   tried to be re-requested.
+
+   LREC_INV_ARG is returned if 'mask' specifies GPIO out of the platform range.
+ */
+lr_errc_t gpio_cdev_request(gpio_hndl_t *p_hndl, uint64_t mask);
+lr_errc_t gpio_cdev_release(gpio_hndl_t *p_hndl, uint64_t mask);
+
+/* CDEV driver lines configuration: bias and drive (OR'ed). */
+#define GPIO_CDEV_BIAS_AS_IS        0x0000
+#define GPIO_CDEV_BIAS_DISABLED     0x0001
+#define GPIO_CDEV_BIAS_PULL_DOWN    0x0002
+#define GPIO_CDEV_BIAS_PULL_UP      0x0003
+#define GPIO_CDEV_DRIVE_PUSH_PULL   0x0000
+#define GPIO_CDEV_DRIVE_OPEN_DRAIN  0x0010
+#define GPIO_CDEV_DRIVE_OPEN_SOURCE 0x0020
+
+/* Set bias and drive configuration (GPIO_CDEV_XXX values OR'ed) of requested
+   lines specified by 'mask' for the CDEV driver. The configuration is set by
+   a single ioctl() call. The drive configuration is effective for output lines
+   only.
+ */
+lr_errc_t gpio_cdev_set_config(
+    gpio_hndl_t *p_hndl, uint64_t mask, unsigned int cfg);
+
+/* GPIO edge event as reported by the CDEV driver. */
+typedef struct _gpio_event_t
+{
+    uint64_t ts;            /* kernel timestamp (CLOCK_MONOTONIC) [ns] */
+    uint32_t seqno;         /* sequence number among all lines of the handle */
+    uint32_t line_seqno;    /* sequence number of the line */
+    unsigned int gpio;      /* GPIO the event occurred on */
+    unsigned int event;     /* GPIO_EVENT_RAISING or GPIO_EVENT_FALLING */
+} gpio_event_t;
+
+/* Set size of the kernel's buffer (number of events) for edge events of the
+   lines requested for the CDEV driver. 0 sets the kernel default (16 events
+   per requested line). Once the buffer overflows the oldest events are lost,
+   which may be detected by gaps in the events sequence numbers.
+
+   If there are lines already requested they are re-requested (see
+   gpio_cdev_request()) for the new buffer size to take effect.
+ */
+lr_errc_t gpio_cdev_set_event_buf(gpio_hndl_t *p_hndl, unsigned int n_evs);
+
+/* Read edge events detected on the requested lines (see gpio_set_event()) and
+   write them under 'p_evs' array of 'n_evs' size. Number of events read is
+   written under 'p_n_read'. The function waits 'timeout' milliseconds
+   (infinite time if <0) for the first event to occur, then all pending events
+   (up to 'n_evs') are read in as few read() calls as possible.
+
+   LREC_SUCCESS is returned if any event has been read, LREC_TIMEOUT means
+   timeout, LREC_NOINIT no lines requested, other error informs about some other
+   problem (e.g poll() error).
+ */
+lr_errc_t gpio_cdev_read_events(gpio_hndl_t *p_hndl,
+    gpio_event_t *p_evs, size_t n_evs, size_t *p_n_read, int timeout);
+
 #ifdef __cplusplus
 }
 #endif
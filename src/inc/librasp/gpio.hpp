@@ -0,0 +1,211 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_HPP__
+#define __LR_GPIO_HPP__
+
+#if __cplusplus < 201703L
+# error "librasp/gpio.hpp requires C++17"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "librasp/gpio.h"
+
+/* Compile-time GPIO pins and ports (C++17, header only).
+
+   Pin<N> and Port<N...> templates provide I/O driver fast path access (see
+   gpio_io_xxx_fast() in librasp/gpio.h) with registers offsets, bit masks
+   and GPFSELn fields positions being compile-time constants. E.g.
+   Port<4,5,6,7>::write(&hndl, x) results in a shift, two masks and two stores
+   (GPSET0, GPCLR0). Non-contiguous pins, pins spanning both banks and
+   descending pins order are supported as well (bit i of the port value maps
+   to the i-th template argument pin).
+
+   NOTE: As for the C fast path, the handle must have I/O (or SIM) driver
+   initialized; no driver dispatch nor arguments checks are performed. For
+   the SIM driver the simulator must be synchronized by the caller (see
+   librasp/sim.h). The GPIOs direction is set via the C API (thread-safe, not
+   timing critical).
+ */
+
+namespace librasp {
+
+namespace detail {
+
+inline volatile uint32_t &reg(gpio_hndl_t *p_hndl, uint32_t r)
+{
+    return *IO_REG32_PTR(p_hndl->io.p_gpio_io, r);
+}
+
+} // namespace detail
+
+template<unsigned int N>
+struct Pin
+{
+    static_assert(N < GPIO_NUM, "GPIO out of the platform range");
+
+    static constexpr unsigned int num = N;
+    static constexpr unsigned int bank = N>>5;
+    static constexpr unsigned int shift = N&0x1f;
+    static constexpr uint32_t bit = (uint32_t)1<<shift;
+    static constexpr uint64_t mask = (uint64_t)1<<N;
+
+    /* registers offsets */
+    static constexpr uint32_t set_reg = GPSET0+sizeof(uint32_t)*bank;
+    static constexpr uint32_t clr_reg = GPCLR0+sizeof(uint32_t)*bank;
+    static constexpr uint32_t lev_reg = GPLEV0+sizeof(uint32_t)*bank;
+
+    /* GPFSELn function field (3 bits) */
+    static constexpr uint32_t fsel_reg = GPFSEL0+sizeof(uint32_t)*(N/10);
+    static constexpr unsigned int fsel_shift = 3*(N%10);
+
+    static void set(gpio_hndl_t *p_hndl) {
+        detail::reg(p_hndl, set_reg) = bit;
+    }
+
+    static void clr(gpio_hndl_t *p_hndl) {
+        detail::reg(p_hndl, clr_reg) = bit;
+    }
+
+    static void write(gpio_hndl_t *p_hndl, unsigned int val) {
+        detail::reg(p_hndl, (val ? set_reg : clr_reg)) = bit;
+    }
+
+    static unsigned int read(gpio_hndl_t *p_hndl) {
+        return (unsigned int)((detail::reg(p_hndl, lev_reg)>>shift)&1);
+    }
+
+    static lr_errc_t direction_input(gpio_hndl_t *p_hndl) {
+        return gpio_direction_input(p_hndl, N);
+    }
+
+    static lr_errc_t direction_output(gpio_hndl_t *p_hndl, unsigned int val) {
+        return gpio_direction_output(p_hndl, N, val);
+    }
+};
+
+template<unsigned int... N>
+struct Port
+{
+    static_assert(sizeof...(N) > 0 && sizeof...(N) <= 32,
+        "Port width must be in 1..32 range");
+    static_assert(((N < GPIO_NUM) && ...), "GPIO out of the platform range");
+
+    static constexpr std::size_t width = sizeof...(N);
+    static constexpr uint64_t mask = (Pin<N>::mask | ...);
+    static_assert(__builtin_popcountll(mask)==width, "Duplicated port pins");
+
+    static constexpr uint32_t mask0 = (uint32_t)mask;
+    static constexpr uint32_t mask1 = (uint32_t)(mask>>32);
+
+private:
+    static constexpr unsigned int pins[] = {N...};
+
+    /* pins are consecutive ascending: port value is mapped by a shift */
+    static constexpr bool contiguous() {
+        for (std::size_t i=1; i<width; i++)
+            if (pins[i]!=pins[0]+i) return false;
+        return true;
+    }
+
+    template<std::size_t... I>
+    static constexpr uint64_t spread(uint32_t val, std::index_sequence<I...>) {
+        return ((((uint64_t)(val>>I)&1)<<pins[I]) | ...);
+    }
+
+    template<std::size_t... I>
+    static constexpr uint32_t gather(uint64_t levs, std::index_sequence<I...>) {
+        return ((((uint32_t)(levs>>pins[I])&1)<<I) | ...);
+    }
+
+public:
+    /* Port value to GPIOs levels */
+    static constexpr uint64_t to_levs(uint32_t val)
+    {
+        if constexpr (contiguous()) {
+            return ((uint64_t)val<<pins[0]) & mask;
+        } else {
+            return spread(val, std::make_index_sequence<width>{});
+        }
+    }
+
+    /* GPIOs levels to port value */
+    static constexpr uint32_t from_levs(uint64_t levs)
+    {
+        if constexpr (contiguous()) {
+            return (uint32_t)((levs & mask)>>pins[0]);
+        } else {
+            return gather(levs, std::make_index_sequence<width>{});
+        }
+    }
+
+    /* Set/clear the port pins specified by 'val' bits */
+    static void set(gpio_hndl_t *p_hndl, uint32_t val)
+    {
+        uint64_t levs = to_levs(val);
+
+        if constexpr (mask0!=0) detail::reg(p_hndl, GPSET0) = (uint32_t)levs;
+        if constexpr (mask1!=0) detail::reg(p_hndl, GPSET1) = (uint32_t)(levs>>32);
+    }
+
+    static void clr(gpio_hndl_t *p_hndl, uint32_t val)
+    {
+        uint64_t levs = to_levs(val);
+
+        if constexpr (mask0!=0) detail::reg(p_hndl, GPCLR0) = (uint32_t)levs;
+        if constexpr (mask1!=0) detail::reg(p_hndl, GPCLR1) = (uint32_t)(levs>>32);
+    }
+
+    /* Write the port value */
+    static void write(gpio_hndl_t *p_hndl, uint32_t val)
+    {
+        uint64_t levs = to_levs(val);
+
+        if constexpr (mask0!=0) {
+            detail::reg(p_hndl, GPSET0) = (uint32_t)levs;
+            detail::reg(p_hndl, GPCLR0) = ~(uint32_t)levs & mask0;
+        }
+        if constexpr (mask1!=0) {
+            detail::reg(p_hndl, GPSET1) = (uint32_t)(levs>>32);
+            detail::reg(p_hndl, GPCLR1) = ~(uint32_t)(levs>>32) & mask1;
+        }
+    }
+
+    /* Read the port value */
+    static uint32_t read(gpio_hndl_t *p_hndl)
+    {
+        uint64_t levs=0;
+
+        if constexpr (mask0!=0) levs = detail::reg(p_hndl, GPLEV0);
+        if constexpr (mask1!=0)
+            levs |= (uint64_t)detail::reg(p_hndl, GPLEV1)<<32;
+        return from_levs(levs);
+    }
+
+    static lr_errc_t direction_input(gpio_hndl_t *p_hndl) {
+        return gpio_bcm_set_func_mask(p_hndl, mask, gpio_bcm_in);
+    }
+
+    /* Configure the port as output of 'val' initial value */
+    static lr_errc_t direction_output(gpio_hndl_t *p_hndl, uint32_t val)
+    {
+        lr_errc_t ret = gpio_write_bank(p_hndl, mask, to_levs(val));
+        return (ret!=LREC_SUCCESS ? ret :
+            gpio_bcm_set_func_mask(p_hndl, mask, gpio_bcm_out));
+    }
+};
+
+} // namespace librasp
+
+#endif /* __LR_GPIO_HPP__ */
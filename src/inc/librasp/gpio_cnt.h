@@ -0,0 +1,130 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_CNT_H__
+#define __LR_GPIO_CNT_H__
+
+#include <pthread.h>
+#include "librasp/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Edge events source */
+typedef enum _gpio_cnt_src_t
+{
+    /* CDEV driver edge events read in batches (see gpio_cdev_read_events()).
+       Events dropped on the kernel's buffer overflow are still counted (by the
+       line sequence numbers gaps). */
+    gpio_cnt_cdev=0,
+
+    /* BCM's event detect status registers (GPEDSn) polled with a given rate.
+       At most one edge per GPIO is counted per poll, therefore the pulses rate
+       must be lower than the polling rate. Requires the library configured
+       with CONFIG_BCM_GPIO_EVENTS. */
+    gpio_cnt_bcm
+} gpio_cnt_src_t;
+
+/* Number of the frequency sliding window slots */
+#define GPIO_CNT_SLOTS  10
+
+/* Max number of events read in a single batch (CDEV source) */
+#define GPIO_CNT_BATCH  64
+
+/* Counted GPIO state */
+typedef struct _gpio_cnt_pin_t
+{
+    unsigned int edge;      /* counted edges (GPIO_EVENT_XXX) */
+
+    /* published by the counter thread; seqlock protected */
+    uint32_t seq;
+    uint64_t count;         /* number of edges */
+    uint64_t first_ts;      /* 1st/last edge timestamps (CLOCK_MONOTONIC) [ns] */
+    uint64_t last_ts;
+    uint64_t freq;          /* frequency over the window [mHz] */
+
+    /* counter thread private */
+    uint32_t line_seqno;    /* last CDEV line sequence number */
+    uint32_t slots[GPIO_CNT_SLOTS];
+} gpio_cnt_pin_t;
+
+/* Counted GPIO readings */
+typedef struct _gpio_cnt_stat_t
+{
+    uint64_t count;
+    uint64_t first_ts;      /* 0 if no edge counted */
+    uint64_t last_ts;
+    double freq;            /* [Hz] */
+} gpio_cnt_stat_t;
+
+typedef struct _gpio_cnt_t
+{
+    gpio_hndl_t *p_gpio_h;
+    gpio_cnt_src_t src;
+    uint32_t period;        /* BCM source polling period [ns] */
+    uint64_t slot_len;      /* window slot length [ns] */
+
+    uint64_t pins;          /* counted GPIOs */
+    gpio_cnt_pin_t cnts[GPIO_NUM];
+
+    /* counter thread related */
+    pthread_t thrd;
+    bool_t run;
+    bool_t rt;              /* real-time scheduler set */
+    uint64_t n_reads;       /* number of events batches (polls) */
+    uint64_t n_overruns;    /* number of missed polls (BCM source) */
+    uint64_t n_errs;        /* number of events read errors */
+} gpio_cnt_t;
+
+/* Initialize pulse counter object counting edges of GPIOs of 'p_gpio_h' handle
+   from 'src' events source. 'rate' [Hz] is the GPEDSn polling rate for BCM
+   source (ignored for CDEV). Frequencies are calculated over 'win' [ms]
+   sliding window (updated every 'win'/GPIO_CNT_SLOTS). The GPIO handle must be
+   valid for the whole life time of the object and have the driver proper for
+   the source set (CDEV or I/O/SIM).
+ */
+lr_errc_t gpio_cnt_init(gpio_cnt_t *p_cnt, gpio_hndl_t *p_gpio_h,
+    gpio_cnt_src_t src, uint32_t rate, uint32_t win);
+
+/* Free pulse counter object; the counter is stopped if running.
+ */
+void gpio_cnt_free(gpio_cnt_t *p_cnt);
+
+/* Add 'gpio' counting 'edge' (GPIO_EVENT_RAISING, GPIO_EVENT_FALLING or
+   GPIO_EVENT_BOTH) edges; the edge detection is set by gpio_set_event().
+   GPIOs may be added for stopped counter only.
+
+   GPIO pre-call state:
+       [in]: requested line for CDEV source.
+ */
+lr_errc_t gpio_cnt_add(gpio_cnt_t *p_cnt, unsigned int gpio, unsigned int edge);
+
+/* Start/stop the counter thread. The thread is run with the real-time
+   scheduler of the maximum priority (if allowed). Counters are zeroed on start
+   and edges detected before the start (e.g. while stopped) are discarded.
+ */
+lr_errc_t gpio_cnt_start(gpio_cnt_t *p_cnt);
+void gpio_cnt_stop(gpio_cnt_t *p_cnt);
+
+/* Read counted 'gpio' state. The function is lock-free (the readings are
+   consistent snapshot) and may be called at any time from any thread. For
+   GPIO_EVENT_BOTH edges the frequency is half of the edges rate.
+ */
+lr_errc_t
+    gpio_cnt_read(gpio_cnt_t *p_cnt, unsigned int gpio, gpio_cnt_stat_t *p_stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_GPIO_CNT_H__ */
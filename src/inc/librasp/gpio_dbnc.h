@@ -0,0 +1,138 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_DBNC_H__
+#define __LR_GPIO_DBNC_H__
+
+#include <pthread.h>
+#include "librasp/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Debounce filter type */
+typedef enum _gpio_dbnc_filter_t
+{
+    /* Integrator: counter incremented for high and decremented for low input
+       samples (saturated at 0 and 'n'). Filtered level changes to high when
+       the counter reaches 'n' and to low when it reaches 0. Glitches shorter
+       than the integrated level are suppressed. */
+    gpio_dbnc_integrator=0,
+
+    /* Stable-count: filtered level changes when the input is stable at
+       the new level for 'n' consecutive samples. */
+    gpio_dbnc_stable
+} gpio_dbnc_filter_t;
+
+/* Debounce engine statistics */
+typedef struct _gpio_dbnc_stats_t
+{
+    uint64_t n_ticks;       /* number of sampling ticks */
+    uint64_t n_overruns;    /* number of missed ticks */
+    uint64_t n_events;      /* number of emitted events */
+    uint64_t n_dropped;     /* number of events dropped on full queue */
+    uint64_t n_errs;        /* number of GPIOs read errors */
+} gpio_dbnc_stats_t;
+
+typedef struct _gpio_dbnc_t
+{
+    gpio_hndl_t *p_gpio_h;
+    uint32_t period;        /* sampling period [ns] */
+
+    /* configuration; updated atomically */
+    uint64_t pins;          /* debounced GPIOs */
+    uint64_t integ;         /* GPIOs with the integrator filter */
+    uint8_t ns[GPIO_NUM];   /* filters lengths */
+    uint64_t upd;           /* updated GPIOs (to be applied by the engine) */
+
+    uint64_t levs;          /* filtered levels */
+
+    /* events queue (single producer, single consumer) */
+    gpio_event_t *p_evs;
+    uint32_t n_evs;         /* queue capacity */
+    uint32_t head;          /* write index (engine thread) */
+    uint32_t tail;          /* read index (consumer) */
+    int evfd;               /* events notification eventfd */
+
+    /* engine thread related */
+    pthread_t thrd;
+    bool_t run;
+    bool_t rt;              /* real-time scheduler set */
+    gpio_dbnc_stats_t stats;
+} gpio_dbnc_t;
+
+/* Max filter length */
+#define GPIO_DBNC_MAX_N     255U
+
+/* Initialize debounce engine object sampling GPIOs via 'p_gpio_h' handle with
+   'rate' [Hz]. Filtered edge events are passed via 'n_evs' long queue. The
+   GPIO handle must be valid for the whole life time of the object.
+
+   The GPIOs are sampled by gpio_read_bank() (single bank read per tick)
+   therefore any GPIO driver may be used, I/O driver is recommended for kHz
+   rates.
+ */
+lr_errc_t gpio_dbnc_init(gpio_dbnc_t *p_dbnc,
+    gpio_hndl_t *p_gpio_h, uint32_t rate, uint32_t n_evs);
+
+/* Free debounce engine object; the engine is stopped if running.
+ */
+void gpio_dbnc_free(gpio_dbnc_t *p_dbnc);
+
+/* Start/stop the debounce engine thread. The thread is run with the real-time
+   scheduler of the maximum priority (if allowed).
+ */
+lr_errc_t gpio_dbnc_start(gpio_dbnc_t *p_dbnc);
+void gpio_dbnc_stop(gpio_dbnc_t *p_dbnc);
+
+/* Add 'gpio' to the debounced GPIOs with 'filter' of length 'n' samples
+   (1..GPIO_DBNC_MAX_N), or remove it. The GPIO must be configured as an input.
+   The updates are lock-free and may be called for running engine; the filter
+   state of the updated GPIO is restarted with the current input level.
+ */
+lr_errc_t gpio_dbnc_add(gpio_dbnc_t *p_dbnc,
+    unsigned int gpio, gpio_dbnc_filter_t filter, unsigned int n);
+lr_errc_t gpio_dbnc_del(gpio_dbnc_t *p_dbnc, unsigned int gpio);
+
+/* Get filtered levels of the debounced GPIOs (use GPIO_LEV() to get level of
+   a specific GPIO).
+ */
+#define gpio_dbnc_levels(p_dbnc) \
+    __atomic_load_n(&(p_dbnc)->levs, __ATOMIC_ACQUIRE)
+
+/* Get the events notification handle. The handle may be added to poll(),
+   epoll or select() sets; it becomes readable if there are events to read.
+ */
+#define gpio_dbnc_fd(p_dbnc) ((p_dbnc)->evfd)
+
+/* Read up to 'n_evs' filtered edge events into 'p_evs' table; the number of
+   read events is written under 'p_n_read'. If there are no events the
+   function waits up to 'timeout' milliseconds (infinite time if <0) for them.
+   Events timestamps (CLOCK_MONOTONIC) are taken at the sampling tick detecting
+   the filtered level change, GPIO_EVENT_RAISING or GPIO_EVENT_FALLING is
+   reported. LREC_TIMEOUT is returned if no events have been read.
+
+   NOTE: Single consumer thread is supported.
+ */
+lr_errc_t gpio_dbnc_read_events(gpio_dbnc_t *p_dbnc,
+    gpio_event_t *p_evs, size_t n_evs, size_t *p_n_read, int timeout);
+
+/* Get copy of the engine statistics.
+ */
+void gpio_dbnc_get_stats(gpio_dbnc_t *p_dbnc, gpio_dbnc_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_GPIO_DBNC_H__ */
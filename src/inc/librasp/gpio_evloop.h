@@ -0,0 +1,90 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_EVLOOP_H__
+#define __LR_GPIO_EVLOOP_H__
+
+#include "librasp/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* GPIO event callback. 'p_ev' points to the detected event. For the SYSFS
+   driver the event timestamp is taken at the wake-up time, its sequence
+   numbers are not set and the event type is deduced from the GPIO level read
+   after the wake-up.
+ */
+typedef void (*gpio_evloop_cb_t)(
+    gpio_hndl_t *p_gpio_h, const gpio_event_t *p_ev, void *arg);
+
+typedef struct _gpio_evloop_t
+{
+    gpio_hndl_t *p_gpio_h;
+
+    int epfd;           /* epoll handle */
+    uint64_t gpios;     /* watched GPIOs */
+    uint64_t sysfs;     /* watched GPIOs via SYSFS handles */
+    int cdevfd;         /* CDEV lines request handle registered (-1: none) */
+    unsigned int cdev_req_id;   /* id of the registered lines request */
+
+    struct {
+        gpio_evloop_cb_t cb;
+        void *arg;
+    } cbs[GPIO_NUM];
+} gpio_evloop_t;
+
+/* Initialize GPIO event loop object for a GPIO handle 'p_gpio_h'. The handle
+   must be valid for the whole life time of the event loop.
+ */
+lr_errc_t gpio_evloop_init(gpio_evloop_t *p_loop, gpio_hndl_t *p_gpio_h);
+
+/* Free GPIO event loop object.
+ */
+void gpio_evloop_free(gpio_evloop_t *p_loop);
+
+/* Get the event loop's epoll handle. The handle may be added to other poll(),
+   epoll or select() sets; it becomes readable if there are any events pending
+   to be dispatched by gpio_evloop_wait().
+ */
+#define gpio_evloop_fd(p_loop) ((p_loop)->epfd)
+
+/* Add/remove 'gpio' to/from the watched GPIOs. The GPIO's event detection must
+   be set by gpio_set_event(). 'cb' (may be NULL) is called with 'arg' for each
+   dispatched event of the GPIO.
+
+   The GPIO is watched via the active driver of the loop's GPIO handle:
+   - For SYSFS driver the GPIO must be already configured as an input.
+   - For CDEV driver the GPIO line must be requested. All lines of the handle
+     share the same lines request, therefore a single epoll entry serves all
+     watched GPIOs.
+   Other drivers are not supported (LREC_NOT_SUPP).
+ */
+lr_errc_t gpio_evloop_add(gpio_evloop_t *p_loop,
+    unsigned int gpio, gpio_evloop_cb_t cb, void *arg);
+lr_errc_t gpio_evloop_del(gpio_evloop_t *p_loop, unsigned int gpio);
+
+/* Wait up to 'timeout' milliseconds (infinite time if <0) for events on the
+   watched GPIOs and dispatch them to the GPIOs callbacks. Mask of GPIOs with
+   dispatched events is written under 'p_ready' (may be NULL). LREC_SUCCESS is
+   returned if any event has been dispatched, LREC_TIMEOUT means timeout (or
+   the wait interrupted by a signal), other error informs about some other
+   problem (e.g epoll_wait() error).
+ */
+lr_errc_t gpio_evloop_wait(
+    gpio_evloop_t *p_loop, int timeout, uint64_t *p_ready);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_GPIO_EVLOOP_H__ */
@@ -0,0 +1,131 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_LA_H__
+#define __LR_GPIO_LA_H__
+
+#include <stdio.h>
+#include "librasp/gpio.h"
+#include "librasp/clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Capture trigger condition */
+typedef enum _gpio_la_trig_t
+{
+    gpio_la_trig_none=0,    /* start capture immediately */
+    gpio_la_trig_level,     /* GPIOs of the trigger mask at trigger levels */
+    gpio_la_trig_change     /* level change on any GPIO of the trigger mask */
+} gpio_la_trig_t;
+
+/* Capture configuration */
+typedef struct _gpio_la_cfg_t
+{
+    uint64_t mask;          /* captured GPIOs (OR'ed GPIO_MASK() values) */
+
+    gpio_la_trig_t trig;    /* trigger condition */
+    uint64_t trig_mask;     /* trigger GPIOs */
+    uint64_t trig_levs;     /* trigger levels (gpio_la_trig_level) */
+    uint32_t trig_timeout;  /* max time [us] to wait for trigger (0: infinite) */
+    size_t n_pretrig;       /* max number of records kept before trigger */
+
+    uint32_t duration;      /* capture time [us] after trigger */
+    uint32_t max_rate;      /* max sample rate [Hz] (0: unlimited) */
+} gpio_la_cfg_t;
+
+/* Captured record: GPIOs levels since STC tick */
+typedef struct _gpio_la_rec_t
+{
+    uint64_t levs;
+    uint32_t tick;
+} gpio_la_rec_t;
+
+/* Capture statistics */
+typedef struct _gpio_la_stats_t
+{
+    uint64_t n_samples;     /* number of taken samples */
+    uint64_t n_dropped;     /* estimated number of missed samples */
+    uint32_t max_gap;       /* max time [us] between consecutive samples */
+    uint32_t elapsed;       /* sampling time [us] */
+    uint32_t rate;          /* achieved sample rate [Hz] */
+    bool_t overflow;        /* capture stopped due to full records buffer */
+} gpio_la_stats_t;
+
+typedef struct _gpio_la_t
+{
+    gpio_hndl_t *p_gpio_h;
+    clock_hndl_t *p_clk_h;
+
+    /* records ring buffer */
+    gpio_la_rec_t *p_recs;
+    size_t n_recs;          /* ring capacity */
+    size_t first;           /* first record index */
+    size_t count;           /* number of records */
+    size_t trig_rec;        /* trigger record (offset from the first record) */
+    uint32_t end_tick;      /* STC tick of the capture end */
+
+    gpio_la_cfg_t cfg;
+    gpio_la_stats_t stats;
+} gpio_la_t;
+
+/* Initialize logic analyzer object with records ring buffer of 'n_recs'
+   capacity. GPIO and clock handles must be valid for the whole life time of
+   the object and must have initialized I/O (or SIM) drivers (LREC_NOINIT
+   otherwise).
+ */
+lr_errc_t gpio_la_init(gpio_la_t *p_la,
+    gpio_hndl_t *p_gpio_h, clock_hndl_t *p_clk_h, size_t n_recs);
+
+/* Free logic analyzer object.
+ */
+void gpio_la_free(gpio_la_t *p_la);
+
+/* Capture GPIOs levels as configured by 'p_cfg'.
+
+   GPLEVn registers are sampled in a tight loop with the real-time scheduler
+   raised to the maximum priority (paced by 'max_rate' if specified). Only
+   changes of the captured GPIOs are recorded, each record keeps new levels
+   and STC tick of the change. Before trigger up to 'n_pretrig' latest records
+   are kept (older are overwritten). The trigger record contains levels at the
+   trigger time. The capture stops 'duration' after trigger or on full records
+   buffer (overflow is marked in the statistics).
+
+   LREC_TIMEOUT is returned if the trigger has not been met within
+   'trig_timeout'. Capture statistics are available in 'stats' of the object.
+
+   NOTE: Timestamps resolution is limited to 1us STC tick, therefore the
+   sampling may be paced up to 1MHz rate (use the unlimited rate mode for
+   higher rates). In the unlimited rate mode a sample is considered dropped
+   for each tick w/o any sample taken. Captured records are valid until next
+   capture.
+ */
+lr_errc_t gpio_la_capture(gpio_la_t *p_la, const gpio_la_cfg_t *p_cfg);
+
+/* Get i-th captured record (0: the oldest one); NULL if out of range.
+ */
+#define gpio_la_get_rec(p_la, i) ((i)<(p_la)->count ? \
+    &(p_la)->p_recs[((p_la)->first+(i))%(p_la)->n_recs] : NULL)
+
+/* Export captured records as VCD (Value Change Dump) to 'f' stream (may be
+   loaded by PulseView, GTKWave etc.). The time scale is 1us, time 0 is the
+   first record time, the trigger time is provided in the header comment. Each
+   captured GPIO is dumped as a separate wire signal.
+ */
+lr_errc_t gpio_la_export_vcd(const gpio_la_t *p_la, FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_GPIO_LA_H__ */
@@ -0,0 +1,129 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_PWM_H__
+#define __LR_GPIO_PWM_H__
+
+#include <pthread.h>
+#include "librasp/gpio.h"
+#include "librasp/clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Duty cycle resolution (100% duty cycle) */
+#define GPIO_PWM_DUTY_RES   10000U
+
+/* Min PWM period [us] */
+#define GPIO_PWM_MIN_PERIOD 20U
+
+/* PWM period edge: GPIOs to set and clear at a tick offset from the period
+   start */
+typedef struct _gpio_pwm_edge_t
+{
+    uint32_t tick;
+    uint64_t set;
+    uint64_t clr;
+} gpio_pwm_edge_t;
+
+/* PWM period schedule */
+typedef struct _gpio_pwm_sched_t
+{
+    uint32_t period;
+    unsigned int n_edges;
+    gpio_pwm_edge_t edges[GPIO_NUM+1];
+} gpio_pwm_sched_t;
+
+/* PWM engine statistics */
+typedef struct _gpio_pwm_stats_t
+{
+    uint64_t n_periods;     /* number of generated periods */
+    uint64_t n_edges;       /* number of written edges */
+    uint64_t n_overruns;    /* number of skipped (late) periods */
+    uint32_t max_jitter;    /* max edge delay [us] */
+    uint64_t sum_jitter;    /* sum of edges delays [us] */
+    uint32_t cpu_load;      /* engine thread CPU load [0.1%] (on stop) */
+} gpio_pwm_stats_t;
+
+typedef struct _gpio_pwm_t
+{
+    gpio_hndl_t *p_gpio_h;
+    clock_hndl_t *p_clk_h;
+
+    /* configuration; updated atomically */
+    uint32_t period;
+    uint64_t chans;                 /* PWM channels (GPIOs) */
+    uint32_t duties[GPIO_NUM];
+    uint32_t cfg_gen;               /* configuration generation */
+
+    /* engine thread related */
+    pthread_t thrd;
+    bool_t run;
+    bool_t rt;                      /* real-time scheduler set */
+    gpio_pwm_sched_t sched;         /* current period schedule */
+    gpio_pwm_stats_t stats;
+} gpio_pwm_t;
+
+/* Initialize PWM engine object with 'period' [us]. GPIO and clock handles
+   must be valid for the whole life time of the object and must have
+   initialized I/O (or SIM) drivers (LREC_NOINIT otherwise).
+ */
+lr_errc_t gpio_pwm_init(gpio_pwm_t *p_pwm,
+    gpio_hndl_t *p_gpio_h, clock_hndl_t *p_clk_h, uint32_t period);
+
+/* Free PWM engine object; the engine is stopped if running.
+ */
+void gpio_pwm_free(gpio_pwm_t *p_pwm);
+
+/* Start/stop the PWM engine thread. The thread is run with the real-time
+   scheduler of the maximum priority (if allowed). Stopped engine leaves
+   all the channels GPIOs low.
+ */
+lr_errc_t gpio_pwm_start(gpio_pwm_t *p_pwm);
+void gpio_pwm_stop(gpio_pwm_t *p_pwm);
+
+/* Set PWM period [us] (not less than GPIO_PWM_MIN_PERIOD) common for all
+   channels. Duty cycles are preserved.
+ */
+lr_errc_t gpio_pwm_set_period(gpio_pwm_t *p_pwm, uint32_t period);
+
+/* Set duty cycle of 'gpio' channel (0..GPIO_PWM_DUTY_RES). The GPIO is added
+   to the PWM channels if not already there and must be configured as an
+   output. gpio_pwm_del_chan() removes the channel leaving the GPIO low.
+ */
+lr_errc_t gpio_pwm_set_duty(gpio_pwm_t *p_pwm, unsigned int gpio, uint32_t duty);
+lr_errc_t gpio_pwm_del_chan(gpio_pwm_t *p_pwm, unsigned int gpio);
+
+/*
+   Configuration updates above are lock-free (atomic stores) and may be called
+   at any time from any thread. The engine thread applies them at the next
+   period start by rebuilding the period schedule: list of (tick, set mask,
+   clear mask) edges, each edge written by single GPSETn/GPCLRn writes
+   regardless of the number of switched channels.
+ */
+
+/* Get copy of the engine statistics.
+ */
+void gpio_pwm_get_stats(gpio_pwm_t *p_pwm, gpio_pwm_stats_t *p_stats);
+
+/* Build PWM period schedule for given 'period', channels and their duties.
+   The function is used by the engine, but may be used for schedule preview.
+ */
+void gpio_pwm_build_sched(gpio_pwm_sched_t *p_sched,
+    uint32_t period, uint64_t chans, const uint32_t *p_duties);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_GPIO_PWM_H__ */
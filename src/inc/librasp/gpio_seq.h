@@ -0,0 +1,150 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_SEQ_H__
+#define __LR_GPIO_SEQ_H__
+
+#include "librasp/gpio.h"
+#include "librasp/clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bit-bang micro-sequencer.
+
+   A bit-banged protocol is described as a program of simple ops (appended by
+   gpio_seq_xxx() builders), compiled by gpio_seq_compile() into a flat op
+   array and run by gpio_seq_run() in a single tight loop accessing the mapped
+   BCM's GPIO and STC registers directly (no driver dispatch, no per-op error
+   checks), under the real-time scheduler of the maximum priority.
+
+   Waits are scheduled on a drift-free time line: each wait ends 'ticks' after
+   the end of the previous wait (or the sequence start); an op waiting for
+   GPIOs levels re-synchronizes the time line to the moment the levels have
+   been detected. Waits whose deadlines have already passed are reported as
+   late (see gpio_seq_report_t).
+ */
+
+/* Sequencer ops codes */
+typedef enum _gpio_seq_opc_t
+{
+    gpio_seq_op_set=0,      /* set outputs of 'mask' high */
+    gpio_seq_op_clr,        /* set outputs of 'mask' low */
+    gpio_seq_op_write,      /* set outputs of 'mask' to 'levs' */
+    gpio_seq_op_wait,       /* wait 'arg' STC ticks [us] (time line based) */
+    gpio_seq_op_delay,      /* busy wait 'arg' CPU cycles (see WAIT_CYCLES) */
+    gpio_seq_op_sample,     /* store levels of 'mask' GPIOs into the buffer */
+    gpio_seq_op_stamp,      /* store STC ticks since the sequence start */
+    gpio_seq_op_wait_lev,   /* wait for 'levs' on 'mask' GPIOs with 'arg'
+                               timeout [us] */
+    gpio_seq_op_loop,       /* loop begin: 'arg' iterations */
+    gpio_seq_op_endloop,    /* loop end: jump to 'jmp' op */
+    gpio_seq_op_end
+} gpio_seq_opc_t;
+
+/* Max loops nesting level */
+#define GPIO_SEQ_LOOP_DEPTH 4
+
+/* Sequencer op */
+typedef struct _gpio_seq_op_t
+{
+    gpio_seq_opc_t opc;
+    uint32_t arg;
+    uint32_t jmp;           /* endloop: 1st op of the loop body */
+    unsigned int lvl;       /* loop/endloop: loop nesting level */
+    uint64_t mask;
+    uint64_t levs;
+} gpio_seq_op_t;
+
+/* Sequence run report */
+typedef struct _gpio_seq_report_t
+{
+    uint32_t start;         /* STC tick of the sequence start */
+    uint32_t elapsed;       /* sequence execution time [us] */
+    uint64_t n_ops;         /* number of executed ops */
+    size_t n_samples;       /* number of stored samples/stamps */
+    uint32_t n_late;        /* number of waits started after their deadlines */
+    uint32_t max_late;      /* max wait lateness [us] */
+    int fail_op;            /* index of timed out op (-1 if none) */
+} gpio_seq_report_t;
+
+typedef struct _gpio_seq_t
+{
+    gpio_seq_op_t *p_ops;
+    size_t max_ops;         /* ops array capacity */
+    size_t n_ops;           /* number of ops */
+
+    /* compilation related */
+    lr_errc_t err;          /* 1st error of the builders */
+    unsigned int depth;     /* current loops nesting level */
+    size_t loops[GPIO_SEQ_LOOP_DEPTH];  /* open loops ops */
+    bool_t compiled;
+    size_t n_samples;       /* samples buffer size required by the sequence */
+} gpio_seq_t;
+
+/* Initialize sequence object for up to 'max_ops' ops.
+ */
+lr_errc_t gpio_seq_init(gpio_seq_t *p_seq, size_t max_ops);
+
+/* Free sequence object.
+ */
+void gpio_seq_free(gpio_seq_t *p_seq);
+
+/* Ops builders appending an op to not compiled sequence. Once an error occurs
+   (e.g. LREC_NO_SPACE for full ops array, LREC_INV_ARG for GPIO out of the
+   platform range) it is kept and returned by subsequent builders and
+   gpio_seq_compile(), therefore the builders results may be ignored.
+ */
+lr_errc_t gpio_seq_set(gpio_seq_t *p_seq, uint64_t mask);
+lr_errc_t gpio_seq_clr(gpio_seq_t *p_seq, uint64_t mask);
+lr_errc_t gpio_seq_write(gpio_seq_t *p_seq, uint64_t mask, uint64_t levs);
+lr_errc_t gpio_seq_wait(gpio_seq_t *p_seq, uint32_t ticks);
+lr_errc_t gpio_seq_delay(gpio_seq_t *p_seq, uint32_t cycles);
+lr_errc_t gpio_seq_sample(gpio_seq_t *p_seq, uint64_t mask);
+lr_errc_t gpio_seq_stamp(gpio_seq_t *p_seq);
+lr_errc_t gpio_seq_wait_lev(
+    gpio_seq_t *p_seq, uint64_t mask, uint64_t levs, uint32_t timeout);
+
+/* Loop body enclosed by gpio_seq_loop() and gpio_seq_endloop() is run 'n'
+   times (n>0). Loops may be nested up to GPIO_SEQ_LOOP_DEPTH level.
+ */
+lr_errc_t gpio_seq_loop(gpio_seq_t *p_seq, uint32_t n);
+lr_errc_t gpio_seq_endloop(gpio_seq_t *p_seq);
+
+/* Compile the sequence: check loops balance, terminate the ops array and
+   calculate required samples buffer size (written under 'p_n_samples' if not
+   NULL). LREC_INV_ARG is returned if the samples buffer size (loops unrolled)
+   exceeds the address space. No ops may be appended to the compiled
+   sequence.
+ */
+lr_errc_t gpio_seq_compile(gpio_seq_t *p_seq, size_t *p_n_samples);
+
+/* Run compiled sequence on GPIOs of 'p_gpio_h' timed by 'p_clk_h' STC.
+   The handles must have I/O (or SIM) drivers initialized; the GPIOs must be
+   configured by the caller (e.g. as outputs for set/clr ops). Samples and
+   stamps are written under 'p_samples' array of 'n_samples' size (must be
+   at least the size calculated by gpio_seq_compile()). The run report is
+   written under 'p_rep' (may be NULL) in any case.
+
+   LREC_TIMEOUT is returned if a levels wait timed out (the sequence is
+   aborted then).
+ */
+lr_errc_t gpio_seq_run(const gpio_seq_t *p_seq, gpio_hndl_t *p_gpio_h,
+    clock_hndl_t *p_clk_h, uint64_t *p_samples, size_t n_samples,
+    gpio_seq_report_t *p_rep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_GPIO_SEQ_H__ */
@@ -0,0 +1,176 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_GPIO_WAVE_H__
+#define __LR_GPIO_WAVE_H__
+
+#include <pthread.h>
+#include "librasp/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* DMA paced GPIO waveforms.
+
+   A waveform is a sequence of equally long steps, each one setting/clearing
+   GPIOs of the bank 0 (GPIO 0-31) at the step start. The waveform is compiled
+   into a chain of the BCM's DMA control blocks writing precomputed GPSET0,
+   GPCLR0 masks. Each step is started by a write to the pacing peripheral's
+   FIFO (PWM or PCM) gated by the peripheral's DREQ signal, therefore the
+   steps are timed by the peripheral's clock with no CPU involvement. The
+   chain is placed in a locked, physically contiguous memory allocated by the
+   VideoCore mailbox (/dev/vcio) and may be run once or continuously (looped).
+
+   The control blocks generator (gpio_wave_build()) and the DMA controller
+   model (gpio_wave_dma_exec()) operate on any memory block, therefore the
+   chains may be verified off-target. For GPIO handle with SIM driver the
+   waveform is run by the DMA model in a background thread writing the
+   simulated GPIO registers (the pacing is emulated by the thread's timer).
+
+   NOTE: The DMA/pacing peripherals are not arbitrated by the library. The
+   chosen DMA channel and the PWM (analog audio) or PCM peripheral must not be
+   used by other software (e.g. the kernel) while the waveform is run. Root
+   privileges are required (/dev/mem, /dev/vcio).
+ */
+
+/* Pacing peripheral */
+typedef enum _gpio_wave_pace_t
+{
+    gpio_wave_pace_pwm=0,
+    gpio_wave_pace_pcm      /* max step period: 102.4us */
+} gpio_wave_pace_t;
+
+/* Waveform step: bank 0 GPIOs set/cleared at the step start */
+typedef struct _gpio_wave_step_t
+{
+    uint32_t set;
+    uint32_t clr;
+} gpio_wave_step_t;
+
+/* DMA control block (32 bytes aligned) */
+typedef struct _dma_cb_t
+{
+    uint32_t ti;            /* transfer information (DMA_TI_XXX) */
+    uint32_t src;           /* source bus address */
+    uint32_t dst;           /* destination bus address */
+    uint32_t len;           /* transfer length [bytes] */
+    uint32_t stride;
+    uint32_t next;          /* next control block bus address; 0: end */
+    uint32_t rsvd[2];
+} dma_cb_t;
+
+/* DMA memory block */
+typedef struct _gpio_wave_mem_t
+{
+    volatile void *p_virt;  /* virtual address */
+    uint32_t bus;           /* bus address */
+    size_t size;            /* [bytes] */
+    uint32_t mb_hndl;       /* mailbox memory handle (0: not mailbox memory) */
+} gpio_wave_mem_t;
+
+/* Step period resolution (pacing clock period) [ns] */
+#define GPIO_WAVE_RES       100
+
+/* Min step period [ns] */
+#define GPIO_WAVE_MIN_PERIOD 1000
+
+typedef struct _gpio_wave_t
+{
+    gpio_hndl_t *p_gpio_h;
+    gpio_wave_pace_t pace;
+    unsigned int dma_ch;
+    uint32_t period;        /* step period [ns] */
+
+    gpio_wave_mem_t mem;
+    size_t max_steps;
+    size_t n_steps;         /* loaded waveform steps */
+    bool_t loop;
+
+    /* mapped I/O */
+    int mbox_fd;
+    volatile void *p_dma_io;
+    volatile void *p_pace_io;
+    volatile void *p_cm_io;
+
+    /* SIM driver related */
+    bool_t sim;
+    pthread_t thrd;
+    bool_t run;
+    bool_t busy;
+} gpio_wave_t;
+
+/* Size of the DMA memory block required for 'n_steps' waveform; 0 if the
+   block wouldn't fit 32-bit bus addresses space (too many steps).
+ */
+size_t gpio_wave_mem_size(size_t n_steps);
+
+/* Build control blocks chain of 'n_steps' waveform 'p_steps' paced by 'pace'
+   in memory block 'p_mem' (the chain starts at the block start). If 'loop' is
+   TRUE the chain is circular (run continuously). LREC_NO_SPACE is returned if
+   the memory block is too small, LREC_INV_ARG if 'n_steps' is 0 or too large
+   (see gpio_wave_mem_size()).
+ */
+lr_errc_t gpio_wave_build(const gpio_wave_mem_t *p_mem,
+    const gpio_wave_step_t *p_steps, size_t n_steps, gpio_wave_pace_t pace,
+    bool_t loop);
+
+/* DMA write callback of the DMA model: 'val' is written under 'bus' address.
+   FALSE returned stops the model.
+ */
+typedef bool_t (*gpio_wave_wr_t)(void *arg, uint32_t bus, uint32_t val);
+
+/* DMA controller model. Execute control blocks chain starting at 'cb_bus'
+   placed in 'p_mem' block, up to 'max_cbs' control blocks (0: unlimited).
+   Writes to addresses outside the block are passed to 'wr'. Number of executed
+   control blocks is written under 'p_n_cbs' (may be NULL). LREC_DTA_CRPT is
+   returned for invalid control block (e.g. out of the block, misaligned).
+ */
+lr_errc_t gpio_wave_dma_exec(const gpio_wave_mem_t *p_mem, uint32_t cb_bus,
+    size_t max_cbs, gpio_wave_wr_t wr, void *arg, size_t *p_n_cbs);
+
+/* Initialize waveform object for up to 'max_steps' steps of 'period' [ns]
+   (rounded to GPIO_WAVE_RES) on GPIOs of 'p_gpio_h' handle with I/O or SIM
+   driver, using 'dma_ch' DMA channel (0-6) paced by 'pace' peripheral.
+   LREC_INV_ARG is returned if 'max_steps' is 0 or too large (see
+   gpio_wave_mem_size()).
+ */
+lr_errc_t gpio_wave_init(gpio_wave_t *p_wave, gpio_hndl_t *p_gpio_h,
+    gpio_wave_pace_t pace, unsigned int dma_ch, uint32_t period,
+    size_t max_steps);
+
+/* Free waveform object; the waveform is stopped if run.
+ */
+void gpio_wave_free(gpio_wave_t *p_wave);
+
+/* Load 'n_steps' waveform 'p_steps' to be run once or continuously ('loop').
+   The waveform GPIOs must be configured as outputs by the caller. The
+   waveform must be stopped.
+ */
+lr_errc_t gpio_wave_load(gpio_wave_t *p_wave,
+    const gpio_wave_step_t *p_steps, size_t n_steps, bool_t loop);
+
+/* Start/stop the loaded waveform. Starting the already running waveform has
+   no effect; finished one-shot waveform is run again.
+ */
+lr_errc_t gpio_wave_start(gpio_wave_t *p_wave);
+void gpio_wave_stop(gpio_wave_t *p_wave);
+
+/* TRUE if the waveform is still run (one-shot waveform not finished yet).
+ */
+bool_t gpio_wave_busy(gpio_wave_t *p_wave);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_GPIO_WAVE_H__ */
@@ -0,0 +1,88 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#ifndef __LR_SIM_H__
+#define __LR_SIM_H__
+
+#include "librasp/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* BCM's GPIO and STC simulator.
+
+   The simulator provides in-process GPIO and STC registers blocks used by the
+   GPIO SIM (gpio_drv_sim) and clock SIM (clock_drv_sim) drivers in place of
+   the mapped peripherals, therefore the library (and its devices) may be run
+   and profiled off-target. There is single simulated chip per process shared
+   by all the handles with the SIM driver set. The simulator is available if
+   the library is configured with CONFIG_SIM_DRIVER.
+
+   The simulator state is updated (synchronized) by sim_sync():
+   - STC: ST_CLO/ST_CHI are set to CLOCK_MONOTONIC time [us].
+   - GPSETn/GPCLRn written values are folded into GPIOs output latches and the
+     registers are zeroed (as read from write-only registers).
+   - GPLEVn: GPIOs configured as outputs (GPFSELn) reflect the output latches,
+     inputs are driven by the waveform callback (see sim_set_wave()) or follow
+     the pull resistors configuration (GPIO_PUP_PDN_CNTRL_REGn; the simulated
+     platform is BCM2711). Not driven inputs w/o pull keep their last level.
+   - GPEDSn: events are latched as enabled by GPRENn, GPFENn, GPHENn, GPLENn,
+     GPARENn, GPAFENn. Edges are detected between consecutive updates; both
+     synchronous and asynchronous edge detects behave the same.
+
+   The SIM drivers synchronize the simulator on each GPIO API call (after
+   registers write or before read). The clock SIM driver refreshes the STC
+   registers only. Accesses bypassing the API (e.g. the I/O driver fast path)
+   see the simulator state as of the last update, unless the background update
+   thread is run (see sim_start()). Writes bypassing the API are not
+   accumulated: a GPSETn/GPCLRn register keeps only the last written value
+   until the update, therefore each such write must be followed by sim_sync()
+   (the background update thread doesn't prevent the loss). The library's
+   timing critical engines (sequencer, logic analyzer, PWM) synchronize the
+   simulator by themselves.
+
+   NOTE: GPEDSn write-1-to-clear semantics is supported via the library API
+   only (e.g. gpio_bcm_get_event_stat()); direct register writes are ignored.
+ */
+
+/* Waveform callback producing the simulated external world input signals.
+
+   The callback is called on each simulator update (under the simulator lock)
+   with the current STC 'tick' [us], mask of GPIOs configured as outputs
+   'outs' and their output levels 'out_levs'. The callback returns levels of
+   GPIOs driven externally and writes mask of these GPIOs under 'p_drv'. The
+   outputs always take precedence over the external drive.
+ */
+typedef uint64_t (*sim_wave_cb_t)(void *arg,
+    uint64_t tick, uint64_t outs, uint64_t out_levs, uint64_t *p_drv);
+
+/* Set waveform callback 'cb' called with 'arg' (NULL 'cb' removes the
+   callback; no GPIO is driven externally then).
+ */
+lr_errc_t sim_set_wave(sim_wave_cb_t cb, void *arg);
+
+/* Update the simulator state. The function is thread-safe.
+ */
+void sim_sync(void);
+
+/* Start/stop the simulator background update thread synchronizing the
+   simulator every 'period' [us]. The thread is run with the default scheduler.
+ */
+lr_errc_t sim_start(uint32_t period);
+void sim_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LR_SIM_H__ */
@@ -0,0 +1,270 @@
+/*
+   Copyright (c) 2026 Piotr Stolarz
+   librasp: RPi HW interface library
+
+   Distributed under the 2-clause BSD License (the License)
+   see accompanying file LICENSE for details.
+
+   This software is distributed WITHOUT ANY WARRANTY; without even the
+   implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+   See the License for more information.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "common.h"
+#include "librasp/sim.h"
+#include "librasp/gpio.h"
+
+#if CONFIG_SIM_DRIVER
+
+#define SIM_REGS_NUM    (PAGE_SZ/sizeof(uint32_t))
+
+#define SIM_REG(regs, r)        ((regs)[(r)/sizeof(uint32_t)])
+#define SIM_READ_REG64(regs, r) \
+    ((uint64_t)SIM_REG(regs, r) | ((uint64_t)SIM_REG(regs, (r)+4)<<32))
+#define SIM_WRITE_REG64(regs, r, v) \
+    SIM_REG(regs, r) = (uint32_t)(v); SIM_REG(regs, (r)+4) = (uint32_t)((v)>>32);
+
+/* simulated registers blocks */
+static volatile uint32_t gpio_regs[SIM_REGS_NUM];
+static volatile uint32_t stc_regs[SIM_REGS_NUM];
+
+/* simulated chip state (protected by the lock) */
+static struct
+{
+    pthread_mutex_t lock;
+    unsigned int n_refs;    /* number of attached handles */
+
+    uint64_t latch;         /* outputs latches */
+    uint64_t levs;          /* GPIOs levels */
+    uint64_t eds;           /* latched events */
+
+    sim_wave_cb_t wave_cb;
+    void *wave_arg;
+
+    /* background update thread */
+    pthread_t thrd;
+    bool_t run;
+    uint32_t period;
+} sim = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+/* Mask of GPIOs configured as outputs */
+static uint64_t sim_outs(void)
+{
+    unsigned int i, j;
+    uint64_t outs=0;
+
+    for (i=0; i<6; i++) {
+        uint32_t gpfsel = SIM_REG(gpio_regs, GPFSEL0+sizeof(uint32_t)*i);
+        for (j=0; j<10 && i*10+j<GPIO_NUM; j++, gpfsel>>=3) {
+            if ((gpfsel&7)==1) outs |= GPIO_MASK(i*10+j);
+        }
+    }
+    return outs;
+}
+
+/* Mask of GPIOs pulled up/down (BCM2711 encoding) */
+static void sim_pulls(uint64_t *p_ups, uint64_t *p_dns)
+{
+    unsigned int i, j;
+
+    *p_ups = *p_dns = 0;
+    for (i=0; i<(GPIO_NUM+15)/16; i++) {
+        uint32_t cntrl =
+            SIM_REG(gpio_regs, GPIO_PUP_PDN_CNTRL_REG0+sizeof(uint32_t)*i);
+        for (j=0; j<16 && i*16+j<GPIO_NUM; j++, cntrl>>=2) {
+            if ((cntrl&3)==1) *p_ups |= GPIO_MASK(i*16+j);
+            else if ((cntrl&3)==2) *p_dns |= GPIO_MASK(i*16+j);
+        }
+    }
+}
+
+static uint64_t sim_time_us(void)
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (uint64_t)tp.tv_sec*1000000U + tp.tv_nsec/1000U;
+}
+
+/* Fetch and zero (write-only) register value */
+#define SIM_XCHG_REG(regs, r) \
+    __atomic_exchange_n(&SIM_REG(regs, r), 0, __ATOMIC_ACQ_REL)
+
+/* exported; see header for details */
+void sim_stc_update(void)
+{
+    uint64_t tick = sim_time_us();
+
+    SIM_REG(stc_regs, ST_CHI) = (uint32_t)(tick>>32);
+    SIM_REG(stc_regs, ST_CLO) = (uint32_t)tick;
+}
+
+/* exported; see header for details */
+void sim_sync(void)
+{
+    uint64_t tick, set, clr, outs, ups, dns, drv=0, ext=0, levs, rise, fall;
+
+    pthread_mutex_lock(&sim.lock);
+
+    sim_stc_update();
+    tick = ((uint64_t)SIM_REG(stc_regs, ST_CHI)<<32) | SIM_REG(stc_regs, ST_CLO);
+
+    set = (uint64_t)SIM_XCHG_REG(gpio_regs, GPSET0) |
+        ((uint64_t)SIM_XCHG_REG(gpio_regs, GPSET1)<<32);
+    clr = (uint64_t)SIM_XCHG_REG(gpio_regs, GPCLR0) |
+        ((uint64_t)SIM_XCHG_REG(gpio_regs, GPCLR1)<<32);
+    /* clear wins if both written since the last update
+       (gpio_write_bank() writes GPSETn before GPCLRn) */
+    sim.latch = ((sim.latch|set) & ~clr) & GPIO_MASK_ALL;
+
+    outs = sim_outs();
+    if (sim.wave_cb)
+        ext = sim.wave_cb(sim.wave_arg, tick, outs, sim.latch&outs, &drv);
+    drv &= ~outs;
+    sim_pulls(&ups, &dns);
+
+    levs = (sim.latch & outs) | (ext & drv);
+    levs |= ups & ~(outs|drv);
+    /* floating inputs keep their levels */
+    levs |= sim.levs & ~(outs|drv|ups|dns);
+
+    rise = levs & ~sim.levs;
+    fall = ~levs & sim.levs & GPIO_MASK_ALL;
+    sim.eds |=
+        (rise & (SIM_READ_REG64(gpio_regs, GPREN0) |
+            SIM_READ_REG64(gpio_regs, GPAREN0))) |
+        (fall & (SIM_READ_REG64(gpio_regs, GPFEN0) |
+            SIM_READ_REG64(gpio_regs, GPAFEN0))) |
+        (levs & SIM_READ_REG64(gpio_regs, GPHEN0)) |
+        (~levs & GPIO_MASK_ALL & SIM_READ_REG64(gpio_regs, GPLEN0));
+    sim.levs = levs;
+
+    SIM_WRITE_REG64(gpio_regs, GPLEV0, levs);
+    SIM_WRITE_REG64(gpio_regs, GPEDS0, sim.eds);
+
+    pthread_mutex_unlock(&sim.lock);
+}
+
+/* exported; see header for details */
+void sim_ack_events(uint64_t mask)
+{
+    pthread_mutex_lock(&sim.lock);
+    sim.eds &= ~mask;
+    SIM_WRITE_REG64(gpio_regs, GPEDS0, sim.eds);
+    pthread_mutex_unlock(&sim.lock);
+}
+
+/* exported; see header for details */
+volatile void *sim_attach(bool_t gpio)
+{
+    pthread_mutex_lock(&sim.lock);
+    sim.n_refs++;
+    pthread_mutex_unlock(&sim.lock);
+
+    if (!gpio) sim_stc_update();
+    return (gpio ? (volatile void*)gpio_regs : (volatile void*)stc_regs);
+}
+
+/* exported; see header for details */
+void sim_detach(void)
+{
+    bool_t stop;
+
+    pthread_mutex_lock(&sim.lock);
+    stop = (sim.n_refs && !--sim.n_refs);
+    pthread_mutex_unlock(&sim.lock);
+
+    /* no more users of the simulator */
+    if (stop) sim_stop();
+}
+
+/* exported; see header for details */
+lr_errc_t sim_set_wave(sim_wave_cb_t cb, void *arg)
+{
+    pthread_mutex_lock(&sim.lock);
+    sim.wave_cb = cb;
+    sim.wave_arg = arg;
+    pthread_mutex_unlock(&sim.lock);
+    return LREC_SUCCESS;
+}
+
+/* Simulator background update thread.
+ */
+static void *sim_thrd(void *arg)
+{
+    uint64_t next = sim_time_us();
+    struct timespec tp;
+
+    while (ATOMIC_LOAD(sim.run))
+    {
+        sim_sync();
+
+        next += sim.period;
+        tp.tv_sec = next/1000000U;
+        tp.tv_nsec = (next%1000000U)*1000U;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tp, NULL);
+    }
+    return NULL;
+}
+
+/* exported; see header for details */
+lr_errc_t sim_start(uint32_t period)
+{
+    int err;
+    lr_errc_t ret=LREC_SUCCESS;
+
+    if (!period) {
+        ret=LREC_INV_ARG;
+        goto finish;
+    }
+    if (sim.run) goto finish;
+
+    sim.period = period;
+    ATOMIC_STORE(sim.run, TRUE);
+
+    if ((err=pthread_create(&sim.thrd, NULL, sim_thrd, NULL))!=0) {
+        err_printf("[%s] pthread_create() error: %d; %s\n",
+            __func__, err, strerror(err));
+        ATOMIC_STORE(sim.run, FALSE);
+        ret=LREC_SCHED_ERR;
+    }
+finish:
+    return ret;
+}
+
+/* exported; see header for details */
+void sim_stop(void)
+{
+    if (sim.run) {
+        ATOMIC_STORE(sim.run, FALSE);
+        pthread_join(sim.thrd, NULL);
+    }
+}
+
+#else /* !CONFIG_SIM_DRIVER */
+
+/* exported; see header for details */
+lr_errc_t sim_set_wave(sim_wave_cb_t cb, void *arg)
+{
+    return LREC_NOT_SUPP;
+}
+
+/* exported; see header for details */
+void sim_sync(void)
+{
+}
+
+/* exported; see header for details */
+lr_errc_t sim_start(uint32_t period)
+{
+    return LREC_NOT_SUPP;
+}
+
+/* exported; see header for details */
+void sim_stop(void)
+{
+}
+
+#endif /* CONFIG_SIM_DRIVER */